@@ -13,6 +13,8 @@
 #endif
 
 #include "auto_rig_plugin.h"
+#include "triangle_bvh.h"
+#include "parallel_for.h"
 #include "imgui.h"
 #include "tiny_gltf.h"
 #include "stb_image_write.h"
@@ -32,7 +34,8 @@
 #include <filesystem>
 #include <unordered_map>
 #include <functional>
-#include <queue>          // geodesic skinning (Dijkstra over the mesh surface)
+#include <array>
+#include <bit>            // std::bit_cast / bit_width (radix-heap keys)
 #include <thread>
 #include <chrono>         // worker-future polling (text-to-animation)
 #include <regex>          // light JSON repair for small-model keyframe output
@@ -40,6 +43,13 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#if defined(__x86_64__) || defined(_M_X64)
+#define AR_HAS_X86_SIMD 1
+#include <immintrin.h>                  // SSE2 row kernels (x86-64 baseline)
+#else
+#define AR_HAS_X86_SIMD 0
+#endif
+
 namespace plugins {
 namespace auto_rig {
 
@@ -107,6 +117,9 @@ bool AutoRigPlugin::init(
     rasterizer_      = std::make_unique<SimpleRasterizer>();
     diffusion_model_ = std::make_unique<RigDiffusionModel>();
 
+    // Textured characters overdraw heavily; shade each visible pixel once.
+    rasterizer_->setDeferredShading(true);
+
     // Resolve the models directory once.
     {
         std::string exe_dir = std::filesystem::current_path().string();
@@ -375,6 +388,9 @@ bool AutoRigPlugin::loadMesh(const std::string& path) {
     }
 
     mesh_ = TriangleMesh{};
+    mesh_topology_.reset();
+    // Pooled capture buffers belong to the previous mesh's sessions.
+    if (rasterizer_) rasterizer_->clearCapturePool();
 
     // ---- Helper: compute a node's LOCAL transform matrix -------------------
     auto nodeLocalMatrix = [](const tinygltf::Node& n) -> glm::mat4 {
@@ -448,6 +464,16 @@ bool AutoRigPlugin::loadMesh(const std::string& path) {
     }
 
     // ---- Gather positions and indices from all meshes / primitives ---------
+    //  Textures are always baked into vertex colours: the orbit captures fed to
+    //  the rig model (and written out as training data) shade from those.
+    //  When EVERY primitive samples the same base-colour image, the mesh also
+    //  keeps that image (with its mip chain) plus the per-vertex material tint,
+    //  so interactive previews can sample it per pixel instead.
+    struct TintRange { size_t begin, count; glm::vec3 tint; };
+    std::vector<TintRange> tex_tints;
+    SimpleTexture shared_tex;
+    int  shared_img   = -1;
+    bool single_image = true;
     for (int mi = 0; mi < (int)model.meshes.size(); ++mi) {
         auto& gltf_mesh = model.meshes[mi];
         glm::mat4 world_xform = glm::mat4(1.0f);
@@ -464,6 +490,7 @@ bool AutoRigPlugin::loadMesh(const std::string& path) {
             // Positions.
             auto pos_it = prim.attributes.find("POSITION");
             if (pos_it == prim.attributes.end()) continue;
+            bool prim_shares_tex = false;
             const auto& pos_acc = model.accessors[pos_it->second];
             const auto& pos_bv  = model.bufferViews[pos_acc.bufferView];
             const auto& pos_buf = model.buffers[pos_bv.buffer];
@@ -603,8 +630,9 @@ bool AutoRigPlugin::loadMesh(const std::string& path) {
 
                 // Decode texture image (if any) into a temporary SimpleTexture.
                 SimpleTexture prim_tex;
+                int imgIdx = -1;
                 if (texIdx >= 0 && texIdx < (int)model.textures.size()) {
-                    int imgIdx = model.textures[texIdx].source;
+                    imgIdx = model.textures[texIdx].source;
                     if (imgIdx >= 0 && imgIdx < (int)model.images.size()) {
                         const auto& img = model.images[imgIdx];
                         if (img.width > 0 && img.height > 0 &&
@@ -637,6 +665,13 @@ bool AutoRigPlugin::loadMesh(const std::string& path) {
                 size_t prim_vert_count = mesh_.positions.size() - base_vertex;
                 bool has_prim_uvs = mesh_.texcoords.size() >= mesh_.positions.size();
 
+                if (!prim_tex.empty() && has_prim_uvs &&
+                    (shared_img < 0 || shared_img == imgIdx)) {
+                    if (shared_img < 0) { shared_img = imgIdx; shared_tex = prim_tex; }
+                    tex_tints.push_back({ mesh_.vertex_colors.size(), prim_vert_count,
+                                          diffuse_factor });
+                    prim_shares_tex = true;
+                }
                 for (size_t i = 0; i < prim_vert_count; ++i) {
                     glm::vec3 col = diffuse_factor;
                     if (!prim_tex.empty() && has_prim_uvs) {
@@ -674,9 +709,18 @@ bool AutoRigPlugin::loadMesh(const std::string& path) {
                     mesh_.indices.push_back(base_vertex + i);
                 }
             }
+            if (!prim_shares_tex) single_image = false;
         }
     }
 
+    if (single_image && shared_img >= 0) {
+        mesh_.texture_tints.assign(mesh_.vertex_colors.size(), glm::vec3(1.0f));
+        for (const auto& r : tex_tints)
+            std::fill_n(mesh_.texture_tints.begin() + r.begin, r.count, r.tint);
+        mesh_.base_color_texture = std::move(shared_tex);
+        mesh_.base_color_texture.buildMips();
+    }
+
     mesh_.recomputeBounds();
     if (mesh_.normals.size() != mesh_.positions.size()) {
         mesh_.recomputeNormals();
@@ -930,6 +974,7 @@ bool AutoRigPlugin::captureViews(int num_views, int resolution) {
     float capture_dist = (use_training_scale_ && training_camera_dist_ > 0)
                          ? training_camera_dist_ : camera_distance_;
     // Elevation 0° matches the default rig-editor view (eye level).
+    rasterizer_->recycle(std::move(captures_));
     captures_ = rasterizer_->captureOrbit(mesh_, num_views, resolution,
                                           0.0f, capture_dist);
     fprintf(stderr, "[AutoRig] captured %d views @ %dx%d (capture_dist=%.4f, "
@@ -1715,27 +1760,13 @@ bool AutoRigPlugin::fuseAndBuildSkeleton() {
             const int p = skeleton_.joints[j].parent;
             if (p >= 0 && p < nj) kids[p].push_back(j);
         }
-        // Moller-Trumbore ray vs original-mesh triangle (nearest positive t).
-        auto rayTriM = [&](const glm::vec3& o, const glm::vec3& d,
-                           int ia, int ib, int ic, float& outT) -> bool {
-            const glm::vec3& v0 = mesh_.positions[ia];
-            const glm::vec3& v1 = mesh_.positions[ib];
-            const glm::vec3& v2 = mesh_.positions[ic];
-            const glm::vec3 e1 = v1 - v0, e2 = v2 - v0;
-            const glm::vec3 pv = glm::cross(d, e2);
-            const float det = glm::dot(e1, pv);
-            if (std::fabs(det) < 1e-12f) return false;
-            const float inv = 1.0f / det;
-            const glm::vec3 tv = o - v0;
-            const float u = glm::dot(tv, pv) * inv;
-            if (u < -1e-5f || u > 1.0f + 1e-5f) return false;
-            const glm::vec3 qv = glm::cross(tv, e1);
-            const float vv = glm::dot(d, qv) * inv;
-            if (vv < -1e-5f || u + vv > 1.0f + 1e-5f) return false;
-            const float tt = glm::dot(e2, qv) * inv;
-            if (tt <= 1e-5f) return false;
-            outT = tt; return true;
-        };
+        // Nearest-hit queries against the ORIGINAL (unwelded) triangles; hits
+        // closer than 1e-5 are ignored.
+        std::vector<glm::ivec3> mtris(ntri);
+        for (size_t t = 0; t < ntri; ++t)
+            mtris[t] = { (int)mesh_.indices[t*3], (int)mesh_.indices[t*3+1],
+                         (int)mesh_.indices[t*3+2] };
+        const TriangleBvh meshBvh(mesh_.positions, mtris, 1e-5f);
         const int kCenterPasses = 3;
         int centred = 0;
         for (int pass = 0; pass < kCenterPasses; ++pass) {
@@ -1764,14 +1795,8 @@ bool AutoRigPlugin::fuseAndBuildSkeleton() {
                 for (int s = 0; s < N; ++s) {
                     const float ang = 6.2831853f * (float)s / (float)N;
                     const glm::vec3 dir = u * std::cos(ang) + v * std::sin(ang);
-                    float bestT = 1e30f; bool got = false;
-                    for (size_t t = 0; t < ntri; ++t) {
-                        float tt;
-                        if (!rayTriM(p, dir, mesh_.indices[t*3], mesh_.indices[t*3+1],
-                                     mesh_.indices[t*3+2], tt)) continue;
-                        if (tt < bestT) { bestT = tt; got = true; }
-                    }
-                    if (got) { sum += p + dir * bestT; ++hits; sumd += bestT; }
+                    TriangleBvh::Hit h;
+                    if (meshBvh.closestHit(p, dir, h)) { sum += p + dir * h.t; ++hits; sumd += h.t; }
                 }
                 if (hits >= N / 2) {
                     const glm::vec3 center = sum / (float)hits;
@@ -1815,13 +1840,114 @@ bool AutoRigPlugin::fuseAndBuildSkeleton() {
 //  computeSkinWeights – nearest-bone distance-based skinning.
 // ============================================================================
 
+// Monotone priority queue (radix heap) for Dijkstra over non-negative float
+// distances.  Keys are the IEEE bit patterns of non-negative floats, which
+// order like the floats; every pushed key must be >= the last popped one,
+// which d + w with w >= 0 guarantees.  Bucket i holds keys whose highest bit
+// differing from the last popped key is bit i-1, so an entry moves down at
+// most 32 times and nothing is ever compared against a sibling.
+class RadixHeap {
+public:
+    bool empty() const { return size_ == 0; }
+
+    void push(float key, int v) {
+        const uint32_t k = std::bit_cast<uint32_t>(key);
+        buckets_[bucketOf(k)].push_back({ k, v });
+        ++size_;
+    }
+
+    std::pair<float, int> pop() {
+        if (buckets_[0].empty()) {
+            int i = 1;
+            while (buckets_[i].empty()) ++i;
+            uint32_t lo = UINT32_MAX;
+            for (const auto& e : buckets_[i]) lo = std::min(lo, e.first);
+            last_ = lo;
+            for (const auto& e : buckets_[i]) buckets_[bucketOf(e.first)].push_back(e);
+            buckets_[i].clear();
+        }
+        const std::pair<uint32_t, int> e = buckets_[0].back();
+        buckets_[0].pop_back();
+        --size_;
+        return { std::bit_cast<float>(e.first), e.second };
+    }
+
+private:
+    int bucketOf(uint32_t k) const { return std::bit_width(k ^ last_); }
+
+    std::array<std::vector<std::pair<uint32_t, int>>, 33> buckets_;
+    uint32_t last_ = 0;
+    size_t   size_ = 0;
+};
+
+// Row kernels over the flat W x nb weight / closeness matrices.  Only
+// element-wise operations are vectorized, so every lane rounds exactly like
+// the scalar loop; sums over bones stay scalar and in bone order.
+static void rowAdd(float* d, const float* s, int n) {
+    int i = 0;
+#if AR_HAS_X86_SIMD
+    for (; i + 4 <= n; i += 4)
+        _mm_storeu_ps(d + i, _mm_add_ps(_mm_loadu_ps(d + i), _mm_loadu_ps(s + i)));
+#endif
+    for (; i < n; ++i) d[i] += s[i];
+}
+
+static void rowMul(float* d, float k, int n) {
+    int i = 0;
+#if AR_HAS_X86_SIMD
+    const __m128 kv = _mm_set1_ps(k);
+    for (; i + 4 <= n; i += 4) _mm_storeu_ps(d + i, _mm_mul_ps(_mm_loadu_ps(d + i), kv));
+#endif
+    for (; i < n; ++i) d[i] *= k;
+}
+
+static void rowDiv(float* d, float k, int n) {
+    int i = 0;
+#if AR_HAS_X86_SIMD
+    const __m128 kv = _mm_set1_ps(k);
+    for (; i + 4 <= n; i += 4) _mm_storeu_ps(d + i, _mm_div_ps(_mm_loadu_ps(d + i), kv));
+#endif
+    for (; i < n; ++i) d[i] /= k;
+}
+
+// The K largest positive entries of row[0..n), descending; ties keep the
+// lower index, unused slots are idx -1 / val 0.  A bone can only enter the
+// list if it beats the current K-th value, so four bones at a time are
+// compared against that bound and only the survivors are inserted.
+template <int K>
+static void rowTopK(const float* row, int n, int* idx, float* val) {
+    for (int i = 0; i < K; ++i) { idx[i] = -1; val[i] = 0.0f; }
+    auto insert = [&](int bi) {
+        const float wgt = row[bi];
+        for (int s = 0; s < K; ++s)
+            if (wgt > val[s]) {
+                for (int t = K - 1; t > s; --t) { val[t] = val[t-1]; idx[t] = idx[t-1]; }
+                val[s] = wgt; idx[s] = bi; break;
+            }
+    };
+    int bi = 0;
+#if AR_HAS_X86_SIMD
+    for (; bi + 4 <= n; bi += 4) {
+        int m = _mm_movemask_ps(_mm_cmpgt_ps(_mm_loadu_ps(row + bi), _mm_set1_ps(val[K - 1])));
+        for (; m; m &= m - 1) insert(bi + std::countr_zero(static_cast<unsigned>(m)));
+    }
+#endif
+    for (; bi < n; ++bi)
+        if (row[bi] > val[K - 1]) insert(bi);
+}
+
+const MeshTopology& AutoRigPlugin::meshTopology() {
+    if (!mesh_topology_)
+        mesh_topology_ = std::make_shared<const MeshTopology>(buildMeshTopology(mesh_));
+    return *mesh_topology_;
+}
+
 bool AutoRigPlugin::computeSkinWeights() {
     if (skeleton_.empty() || mesh_.empty()) return false;
 
     const int nv = static_cast<int>(mesh_.positions.size());
     const int nj = static_cast<int>(skeleton_.joints.size());
-    skin_weights_ = SkinWeights{};
-    skin_weights_.per_vertex.resize(nv);
+    skin_weights_ = PackedSkinWeights{};
 
     // ONE bone per joint.  A bone is the segment parent→joint; it is the
     // ray-cast origin line for seeding and the source of the tau falloff width
@@ -1860,113 +1986,27 @@ bool AutoRigPlugin::computeSkinWeights() {
     const int nb = static_cast<int>(bones.size());
     if (nb == 0) return false;
 
-    // ── Build surface connectivity by MANIFOLD EDGE matching ──
-    // The two feet have NO real connection, yet the OLD spatial-cell weld fused
-    // them: it merged any two vertices that shared a tiny grid cell as long as
-    // their normals were not opposing.  Where the separate feet sit close
-    // together their SAME-FACING surfaces (soles point down, tops point up, so
-    // the normals AGREE) got welded into shared vertices — inventing a geodesic
-    // shortcut and bleeding left/right foot weights.
+    // ── Surface connectivity (shared, cached per loaded mesh) ──
+    // Vertices are welded only across COINCIDENT triangle edges, so separate
+    // parts that merely touch (the two feet) stay separate islands and the
+    // per-bone geodesic can never cross between them; see buildMeshTopology.
     //
-    // Instead, two vertices are merged ONLY when they are the endpoints of a
-    // COINCIDENT triangle EDGE — the seam where two triangles of the SAME
-    // surface meet.  Adjacent triangles of one surface always share such an edge
-    // (identical endpoint positions), so every connected surface is rebuilt;
-    // two pieces that merely TOUCH (the feet) share no tessellated edge and stay
-    // SEPARATE islands, so the per-bone geodesic can never cross between them.
-    const glm::vec3 _bext = mesh_.bbox_max - mesh_.bbox_min;
-    const double weld_eps = std::max((double)glm::length(_bext) * 1e-4, 1e-9);
-    auto cellKey = [weld_eps](const glm::vec3& p) -> uint64_t {
-        uint64_t h = 1469598103934665603ull;
-        for (int i = 0; i < 3; ++i) {
-            const int64_t qi = (int64_t)std::llround((double)p[i] / weld_eps);
-            h ^= (uint64_t)qi; h *= 1099511628211ull;
-        }
-        return h;
-    };
-    std::vector<uint64_t> vcell(nv);
-    for (int i = 0; i < nv; ++i) vcell[i] = cellKey(mesh_.positions[i]);
-
-    // Union-find over the original vertices.
-    std::vector<int> uf(nv);
-    for (int i = 0; i < nv; ++i) uf[i] = i;
-    std::function<int(int)> ufFind = [&](int x) {
-        while (uf[x] != x) { uf[x] = uf[uf[x]]; x = uf[x]; }
-        return x;
-    };
-    auto ufUnion = [&](int a, int b) { uf[ufFind(a)] = ufFind(b); };
-
-    // Order-independent key for an edge built from its two endpoint cell keys.
-    auto edgeKey = [](uint64_t ka, uint64_t kb) -> uint64_t {
-        const uint64_t lo = ka < kb ? ka : kb, hi = ka < kb ? kb : ka;
-        uint64_t h = 1469598103934665603ull;
-        h ^= lo; h *= 1099511628211ull;
-        h ^= hi; h *= 1099511628211ull;
-        return h;
-    };
-    // First triangle to claim an edge stores its endpoints; later triangles that
-    // share the SAME spatial edge weld their matching endpoints to it.
-    std::unordered_map<uint64_t, std::pair<int,int>> edgeRep;
-    edgeRep.reserve(mesh_.indices.size());
-    auto stitch = [&](int a, int b) {
-        if (vcell[a] == vcell[b]) return;                 // degenerate edge
-        const uint64_t ek = edgeKey(vcell[a], vcell[b]);
-        auto it = edgeRep.find(ek);
-        if (it == edgeRep.end()) { edgeRep.emplace(ek, std::make_pair(a, b)); return; }
-        const int ra = it->second.first, rb = it->second.second;
-        if (vcell[a] == vcell[ra]) { ufUnion(a, ra); ufUnion(b, rb); }
-        else                       { ufUnion(a, rb); ufUnion(b, ra); }
-    };
-    for (size_t t = 0; t + 2 < mesh_.indices.size(); t += 3) {
-        const int a = mesh_.indices[t], b = mesh_.indices[t + 1],
-                  c = mesh_.indices[t + 2];
-        stitch(a, b); stitch(b, c); stitch(c, a);
-    }
-
-    // Compact union-find roots into dense welded ids → wid / wpos.
-    std::vector<int>       wid(nv);
-    std::vector<glm::vec3> wpos;
-    {
-        std::unordered_map<int,int> root2id;
-        root2id.reserve(static_cast<size_t>(nv));
-        for (int i = 0; i < nv; ++i) {
-            const int r = ufFind(i);
-            auto it = root2id.find(r);
-            if (it == root2id.end()) {
-                const int id = static_cast<int>(wpos.size());
-                root2id.emplace(r, id);
-                wpos.push_back(mesh_.positions[i]);
-                wid[i] = id;
-            } else {
-                wid[i] = it->second;
-            }
-        }
-    }
-    const int W = static_cast<int>(wpos.size());
-
-    // Welded triangle list (shared by the layer split, the skin ray test and
-    // the geodesic graph).
-    std::vector<glm::ivec3> tris;
-    tris.reserve(mesh_.indices.size() / 3);
-    for (size_t t = 0; t + 2 < mesh_.indices.size(); t += 3)
-        tris.push_back({ wid[mesh_.indices[t]], wid[mesh_.indices[t + 1]],
-                         wid[mesh_.indices[t + 2]] });
-
-    // ── LAYER SPLIT: connected components over the welded surface ──
-    // A character often arrives as several stacked layers — skin, clothing,
-    // hair — that we cannot tell apart from metadata.  Exact-position welding
-    // keeps them as SEPARATE connected components (different layers rarely share
-    // a vertex), so a union-find over the triangle edges recovers one component
-    // per layer-piece.
-    std::vector<int> comp(W);
-    for (int i = 0; i < W; ++i) comp[i] = i;
-    auto findc = [&](int x) {
-        while (comp[x] != x) { comp[x] = comp[comp[x]]; x = comp[x]; }
-        return x;
-    };
-    auto unite = [&](int a, int b) { comp[findc(a)] = findc(b); };
-    for (const auto& t : tris) { unite(t.x, t.y); unite(t.y, t.z); }
-    for (int i = 0; i < W; ++i) comp[i] = findc(i);
+    // LAYER SPLIT: a character often arrives as several stacked layers — skin,
+    // clothing, hair — that we cannot tell apart from metadata.  Exact-position
+    // welding keeps them as SEPARATE connected components (different layers
+    // rarely share a vertex), so topo.comp recovers one component per
+    // layer-piece.
+    const MeshTopology& topo = meshTopology();
+    const std::vector<int>&        wid  = topo.wid;
+    const std::vector<glm::vec3>&  wpos = topo.wpos;
+    const std::vector<glm::ivec3>& tris = topo.tris;   // welded triangle list
+    const std::vector<int>&        comp = topo.comp;   // island representative
+    const int W = topo.num_welded;
+
+    // Ray queries against the welded surface go through one BVH built here
+    // (closest-hit / any-hit, see triangle_bvh.h); rayTri remains for the
+    // skin-grid DDA further down.
+    const TriangleBvh bvh(wpos, tris, 1e-6f);
 
     // Ray vs welded triangle (Möller–Trumbore); fills hit distance + barycentric
     // (u,v) for the v1,v2 corners (v0 weight = 1-u-v).
@@ -2001,9 +2041,15 @@ bool AutoRigPlugin::computeSkinWeights() {
     // (>50%) is skin.  Cloth/hair, always sitting behind skin, score low.  A
     // single-component mesh (no separate layers) scores 100% → all skin, i.e.
     // identical behaviour to before.
+    //
+    // Joints are traced in parallel.  Each joint records the components its
+    // rays crossed / hit first in its own slot; the slots are tallied in joint
+    // order afterwards, so the counts never depend on thread scheduling.
     const int kDirs = 128;
-    std::vector<long> firstHits(W, 0), totalHits(W, 0);   // keyed by comp rep
-    for (int j = 0; j < nj; ++j) {
+    struct JointRays { std::vector<int> crossed, first; };   // comp reps
+    std::vector<JointRays> jointRays(nj);
+    parallelFor(nj, [&](int j) {
+        JointRays& out = jointRays[j];
         const glm::vec3 o = skeleton_.joints[j].position;
         for (int s = 0; s < kDirs; ++s) {
             const float k     = static_cast<float>(s) + 0.5f;
@@ -2012,15 +2058,21 @@ bool AutoRigPlugin::computeSkinWeights() {
             const glm::vec3 d(std::sin(phi) * std::cos(theta),
                               std::sin(phi) * std::sin(theta),
                               std::cos(phi));
-            float bestT = 1e30f; int bestComp = -1;
-            for (const auto& t : tris) {
-                float tt, bu, bv;
-                if (!rayTri(o, d, t, tt, bu, bv)) continue;
-                ++totalHits[comp[t.x]];
-                if (tt < bestT) { bestT = tt; bestComp = comp[t.x]; }
-            }
-            if (bestComp >= 0) ++firstHits[bestComp];
+            // Every crossing counts; the nearest one (lowest triangle on a
+            // tie, as in a scan of the triangle list) is the first hit.
+            float bestT = 1e30f; int bestTri = -1;
+            bvh.anyHit(o, d, [&](int ti, float tt) {
+                out.crossed.push_back(comp[tris[ti].x]);
+                if (tt < bestT || (tt == bestT && ti < bestTri)) { bestT = tt; bestTri = ti; }
+                return false;
+            });
+            if (bestTri >= 0) out.first.push_back(comp[tris[bestTri].x]);
         }
+    });
+    std::vector<long> firstHits(W, 0), totalHits(W, 0);   // keyed by comp rep
+    for (const JointRays& jr : jointRays) {
+        for (int c : jr.crossed) ++totalHits[c];
+        for (int c : jr.first)   ++firstHits[c];
     }
     // Decide skin per component representative, then label every vertex (O(W)).
     // Never-hit pockets default to skin so they are still rigged directly; only
@@ -2254,13 +2306,16 @@ bool AutoRigPlugin::computeSkinWeights() {
     // seeds always land on the correct part.  Rays in ALL directions also seed
     // BOTH faces of thick parts (pelvis/torso), and the leaf/root bones are
     // handled by the same rule — no special cases.
+    //
+    // Bones are seeded in parallel; each writes only seeds[bi], in the same
+    // order as a serial pass, so the seed sets are schedule-independent.
     std::vector<std::vector<int>> seeds(nb);
     {
         const int kBoneDirs = 64;     // directions per sample point
         const int kSamples  = 4;      // segment samples (kSamples+1 points)
-        std::vector<std::pair<float, int>> hits;   // (hit distance, triangle)
-        for (int bi = 0; bi < nb; ++bi) {
-            hits.clear();
+        parallelFor(nb, [&](int bi) {
+            std::vector<std::pair<float, int>> hits;   // (hit distance, triangle)
+            hits.reserve((kSamples + 1) * kBoneDirs);
             for (int sp = 0; sp <= kSamples; ++sp) {
                 const float u = static_cast<float>(sp) / kSamples;
                 const glm::vec3 o = bones[bi].a + (bones[bi].b - bones[bi].a) * u;
@@ -2271,12 +2326,10 @@ bool AutoRigPlugin::computeSkinWeights() {
                     const glm::vec3 d(std::sin(phi) * std::cos(theta),
                                       std::sin(phi) * std::sin(theta),
                                       std::cos(phi));
-                    float bestT = 1e30f; int bestTri = -1;
-                    for (size_t ti = 0; ti < tris.size(); ++ti) {
+                    TriangleBvh::Hit h;
+                    const bool got = bvh.closestHit(o, d, [&](int ti, float) {
                         const glm::ivec3& tv = tris[ti];
-                        if (!isSkin[tv.x]) continue;         // skin surface only
-                        float tt, bu, bv;
-                        if (!rayTri(o, d, tv, tt, bu, bv)) continue;
+                        if (!isSkin[tv.x]) return false;     // skin surface only
                         // Only the surface the bone EXITS through (its own
                         // enclosing limb) is a valid seed.  A foreign part across
                         // an air gap is ENTERED — its face normal points back at
@@ -2284,13 +2337,12 @@ bool AutoRigPlugin::computeSkinWeights() {
                         // to the hip would seed the hip.
                         const glm::vec3 fn = glm::cross(wpos[tv.y] - wpos[tv.x],
                                                         wpos[tv.z] - wpos[tv.x]);
-                        if (glm::dot(fn, d) <= 0.0f) continue;
-                        if (tt < bestT) { bestT = tt; bestTri = static_cast<int>(ti); }
-                    }
-                    if (bestTri >= 0) hits.push_back({ bestT, bestTri });
+                        return glm::dot(fn, d) > 0.0f;
+                    }, h);
+                    if (got) hits.push_back({ h.t, h.tri });
                 }
             }
-            if (hits.empty()) continue;
+            if (hits.empty()) return;
             // Local limb radius = MEDIAN nearest-hit distance.  Reject far
             // outliers — rays that escaped along the bone axis into a NEIGHBOUR
             // (e.g. up from the shoulder into the head), which would otherwise
@@ -2328,56 +2380,81 @@ bool AutoRigPlugin::computeSkinWeights() {
                 }
                 if (bestW >= 0) seeds[bi].push_back(bestW);
             }
-        }
+        });
     }
 
     // ── Per-bone GEODESIC distance from its core (multi-source Dijkstra) ──
     // geo[w * nb + bi] = on-surface distance from welded vertex w to bone bi's
     // core.  A hand by the thigh is euclidean-near but a whole arm away across
     // the surface, so its bone never reaches the thigh's vertices.
+    //
+    // The skin graph is flattened to CSR (rows keep adj's edge order) and the
+    // bones run concurrently, each with its own distance array and radix heap.
+    // A label-setting search settles every vertex at the same float distance
+    // whatever the pop order among ties, so geo matches a serial
+    // priority-queue Dijkstra exactly.
+    std::vector<int>   adjPtr(W + 1, 0), adjTo;
+    std::vector<float> adjLen;
+    for (int w = 0; w < W; ++w) adjPtr[w + 1] = adjPtr[w] + static_cast<int>(adj[w].size());
+    adjTo.reserve(adjPtr[W]); adjLen.reserve(adjPtr[W]);
+    for (int w = 0; w < W; ++w)
+        for (const auto& e : adj[w]) { adjTo.push_back(e.first); adjLen.push_back(e.second); }
+
     std::vector<float> geo(static_cast<size_t>(W) * nb, 1e30f);
-    std::vector<float> dist(W);
-    for (int bi = 0; bi < nb; ++bi) {
-        std::fill(dist.begin(), dist.end(), 1e30f);
-        std::priority_queue<std::pair<float, int>,
-                            std::vector<std::pair<float, int>>,
-                            std::greater<std::pair<float, int>>> pq;
+    parallelFor(nb, [&](int bi) {
+        std::vector<float> dist(W, 1e30f);
+        RadixHeap pq;
         for (int s : seeds[bi])
-            if (dist[s] > 0.0f) { dist[s] = 0.0f; pq.push({0.0f, s}); }
+            if (dist[s] > 0.0f) { dist[s] = 0.0f; pq.push(0.0f, s); }
         while (!pq.empty()) {
-            const std::pair<float, int> top = pq.top(); pq.pop();
+            const std::pair<float, int> top = pq.pop();
             const float d = top.first; const int u = top.second;
             if (d > dist[u]) continue;
-            for (const auto& e : adj[u]) {
-                const float nd = d + e.second;
-                if (nd < dist[e.first]) { dist[e.first] = nd; pq.push({nd, e.first}); }
-            }
-        }
-        // ── Blur the geodesic distance over the surface graph ──
-        // Dijkstra on an irregular triangle mesh gives a slightly zig-zag
-        // distance (the path snaps along edges), which shows as banding/streaks
-        // in the closeness field.  A few Laplacian passes (each vertex averaged
-        // with its skin-edge neighbours) smooth it into clean, rounded bands.
-        // Only REACHED vertices participate, so unreachable islands stay at inf.
-        {
-            const int kBlurPasses = 3;
-            std::vector<float> tmp(W);
-            for (int pass = 0; pass < kBlurPasses; ++pass) {
-                for (int w = 0; w < W; ++w) {
-                    if (dist[w] >= 1e29f) { tmp[w] = dist[w]; continue; }
-                    float sum = dist[w]; int cnt = 1;
-                    for (const auto& e : adj[w]) {
-                        const float nd = dist[e.first];
-                        if (nd < 1e29f) { sum += nd; ++cnt; }
-                    }
-                    tmp[w] = sum / (float)cnt;
-                }
-                dist.swap(tmp);
+            for (int k = adjPtr[u]; k < adjPtr[u + 1]; ++k) {
+                const float nd = d + adjLen[k];
+                if (nd < dist[adjTo[k]]) { dist[adjTo[k]] = nd; pq.push(nd, adjTo[k]); }
             }
         }
         // Disconnected islands (no edge path to any seed) stay at inf and are
         // handled by the nearest-skin inheritance below.
         for (int w = 0; w < W; ++w) geo[static_cast<size_t>(w) * nb + bi] = dist[w];
+    });
+
+    // ── Blur the geodesic distance over the surface graph ──
+    // Dijkstra on an irregular triangle mesh gives a slightly zig-zag
+    // distance (the path snaps along edges), which shows as banding/streaks
+    // in the closeness field.  A few Laplacian passes (each vertex averaged
+    // with its skin-edge neighbours) smooth it into clean, rounded bands.
+    // Only REACHED vertices participate, so unreachable islands stay at inf.
+    //
+    // All bones are blurred together, one geo row per vertex, as parallel
+    // sweeps over vertex blocks into a second buffer (Jacobi, double
+    // buffered).  Per bone the sums accumulate in adj order, as before.
+    {
+        const int kBlurPasses = 3;
+        const int kBlurChunk  = 1024;             // vertices per parallel item
+        std::vector<float> geoTmp(geo.size());
+        for (int pass = 0; pass < kBlurPasses; ++pass) {
+            parallelFor((W + kBlurChunk - 1) / kBlurChunk, [&](int chunk) {
+                std::vector<float> sum(nb), cnt(nb);
+                const int w1 = std::min(W, (chunk + 1) * kBlurChunk);
+                for (int w = chunk * kBlurChunk; w < w1; ++w) {
+                    const float* row = &geo[static_cast<size_t>(w) * nb];
+                    float*       out = &geoTmp[static_cast<size_t>(w) * nb];
+                    for (int bi = 0; bi < nb; ++bi) { sum[bi] = row[bi]; cnt[bi] = 1.0f; }
+                    for (int k = adjPtr[w]; k < adjPtr[w + 1]; ++k) {
+                        const float* nrow = &geo[static_cast<size_t>(adjTo[k]) * nb];
+                        for (int bi = 0; bi < nb; ++bi) {
+                            const float nd = nrow[bi];
+                            if (nd < 1e29f) { sum[bi] += nd; cnt[bi] += 1.0f; }
+                        }
+                    }
+                    for (int bi = 0; bi < nb; ++bi)
+                        out[bi] = row[bi] >= 1e29f ? row[bi] : sum[bi] / cnt[bi];
+                }
+            });
+            geo.swap(geoTmp);
+        }
     }
 
     // ── DIAGNOSTIC: graph + per-bone distance stats, to compare against the
@@ -2439,18 +2516,28 @@ bool AutoRigPlugin::computeSkinWeights() {
     // which creased/distorted when posed; 0.35 lets each bone's influence reach
     // well past the joint so adjacent bones share a wide gradient.
     const float kYellow = 0.35f;      // out-of-range threshold (zero beyond it)
-    std::vector<std::vector<float>> Cf(W, std::vector<float>(nb, 0.0f));
-    std::vector<std::vector<float>> Wf(W, std::vector<float>(nb, 0.0f));
-    for (int bi = 0; bi < nb; ++bi) {
-        const float tau_bi = std::max(tau[bi], 1e-4f);     // per-bone falloff width
-        for (int w = 0; w < W; ++w) {
-            const float g = geo[static_cast<size_t>(w) * nb + bi];
-            if (g >= 1e29f) continue;                      // unreachable from this bone
-            const float c = std::exp(-g / tau_bi);         // closeness, 1 at the bone
+    //
+    //    Both are flat row-major W x nb matrices (one row of bones per welded
+    //    vertex, like geo): every pass below walks a vertex and its
+    //    neighbours' rows, so rows are contiguous and the bones vectorize.
+    const size_t NB = static_cast<size_t>(nb);
+    std::vector<float> Cf(static_cast<size_t>(W) * NB, 0.0f);
+    std::vector<float> Wf(static_cast<size_t>(W) * NB, 0.0f);
+    auto cRow = [&](int w) { return Cf.data() + static_cast<size_t>(w) * NB; };
+    auto wRow = [&](int w) { return Wf.data() + static_cast<size_t>(w) * NB; };
+    std::vector<float> tauB(nb);
+    for (int bi = 0; bi < nb; ++bi) tauB[bi] = std::max(tau[bi], 1e-4f);  // per-bone falloff width
+    for (int w = 0; w < W; ++w) {
+        const float* g = &geo[static_cast<size_t>(w) * nb];
+        float* cr = cRow(w);
+        float* wr = wRow(w);
+        for (int bi = 0; bi < nb; ++bi) {
+            if (g[bi] >= 1e29f) continue;                  // unreachable from this bone
+            const float c = std::exp(-g[bi] / tauB[bi]);   // closeness, 1 at the bone
             if (c <= kYellow) continue;                    // out of range -> zero weight
             const float cl = (c - kYellow) / (1.0f - kYellow);
-            Cf[w][bi] = cl;
-            Wf[w][bi] = cl;
+            cr[bi] = cl;
+            wr[bi] = cl;
         }
     }
 
@@ -2466,14 +2553,15 @@ bool AutoRigPlugin::computeSkinWeights() {
     // NOT caught here — it stays unweighted and is reported as an error below.
     for (int w = 0; w < W; ++w) {
         if (!isSkin[w]) continue;
+        const float* wr = wRow(w);
         float s = 0.0f;
-        for (int bi = 0; bi < nb; ++bi) s += Wf[w][bi];
+        for (int bi = 0; bi < nb; ++bi) s += wr[bi];
         if (s > 0.0f) continue;                            // already in range of a bone
         const float* g = &geo[static_cast<size_t>(w) * nb];
         float gmin = 1e29f; int bmin = -1;
         for (int bi = 0; bi < nb; ++bi)
             if (g[bi] < gmin) { gmin = g[bi]; bmin = bi; }
-        if (bmin >= 0 && gmin < 1e29f) Wf[w][bmin] = 1.0f; // surface-nearest bone
+        if (bmin >= 0 && gmin < 1e29f) wRow(w)[bmin] = 1.0f; // surface-nearest bone
     }
 
     // ── Project OUTER layers (cloth/hair) onto the SKIN beneath ──
@@ -2600,11 +2688,13 @@ bool AutoRigPlugin::computeSkinWeights() {
         auto applyHit = [&](int w, int k, float bu, float bv) {
             const glm::ivec3& t = tris[skinTri[k]];
             const float w0 = 1.0f - bu - bv;
+            float* wr = wRow(w);
+            float* cr = cRow(w);
+            const float *wa = wRow(t.x), *wb = wRow(t.y), *wc = wRow(t.z);
+            const float *ca = cRow(t.x), *cb = cRow(t.y), *cc = cRow(t.z);
             for (int bi = 0; bi < nb; ++bi) {
-                Wf[w][bi] = w0 * Wf[t.x][bi] + bu * Wf[t.y][bi]
-                          + bv * Wf[t.z][bi];
-                Cf[w][bi] = w0 * Cf[t.x][bi] + bu * Cf[t.y][bi]
-                          + bv * Cf[t.z][bi];
+                wr[bi] = w0 * wa[bi] + bu * wb[bi] + bv * wc[bi];
+                cr[bi] = w0 * ca[bi] + bu * cb[bi] + bv * cc[bi];
             }
         };
 
@@ -2622,8 +2712,9 @@ bool AutoRigPlugin::computeSkinWeights() {
         for (size_t k = 0; k < skinTri.size(); ++k) {
             const glm::ivec3& t = tris[skinTri[k]];
             int bb = -1; float bw = -1.0f;
+            const float *wa = wRow(t.x), *wb = wRow(t.y), *wc = wRow(t.z);
             for (int bi = 0; bi < nb; ++bi) {
-                const float s = Wf[t.x][bi] + Wf[t.y][bi] + Wf[t.z][bi];
+                const float s = wa[bi] + wb[bi] + wc[bi];
                 if (s > bw) { bw = s; bb = bi; }
             }
             skinTriDom[k] = bb;
@@ -2843,8 +2934,9 @@ bool AutoRigPlugin::computeSkinWeights() {
     size_t skin_fallback = 0, detached_unweighted = 0;
     (void)realSkinW;
     for (int w = 0; w < W; ++w) {
+        const float* wr = wRow(w);
         float s = 0.0f;
-        for (int bi = 0; bi < nb; ++bi) s += Wf[w][bi];
+        for (int bi = 0; bi < nb; ++bi) s += wr[bi];
         if (s > 0.0f) continue;
         const glm::vec3 p = wpos[w];
         float best2 = 1e30f; int bmin = -1;
@@ -2858,7 +2950,7 @@ bool AutoRigPlugin::computeSkinWeights() {
             const float d2 = glm::dot(p - cp, p - cp);
             if (d2 < best2) { best2 = d2; bmin = bi; }
         }
-        if (bmin >= 0) { Wf[w][bmin] = 1.0f; ++skin_fallback; }
+        if (bmin >= 0) { wRow(w)[bmin] = 1.0f; ++skin_fallback; }
         else           { ++detached_unweighted; }
     }
 
@@ -2870,25 +2962,21 @@ bool AutoRigPlugin::computeSkinWeights() {
     // the raw geodesic field, just without the high-frequency noise.
     {
         const int kClosenessSmoothPasses = 2;
-        std::vector<std::vector<float>> tmp(W, std::vector<float>(nb, 0.0f));
+        std::vector<float> tmp(Cf.size(), 0.0f);
         for (int pass = 0; pass < kClosenessSmoothPasses; ++pass) {
             for (int w = 0; w < W; ++w) {
-                std::vector<float>& d = tmp[w];
-                const std::vector<float>& s = Cf[w];
-                for (int bi = 0; bi < nb; ++bi) d[bi] = s[bi];
+                float* d = tmp.data() + static_cast<size_t>(w) * NB;
+                std::copy_n(cRow(w), nb, d);
                 float cnt = 1.0f;
                 for (const auto& e : adj[w]) {           // skin edges
-                    const std::vector<float>& nc = Cf[e.first];
-                    for (int bi = 0; bi < nb; ++bi) d[bi] += nc[bi];
+                    rowAdd(d, cRow(e.first), nb);
                     cnt += 1.0f;
                 }
                 for (const auto& e : adjOuter[w]) {      // cloth/hair edges
-                    const std::vector<float>& nc = Cf[e.first];
-                    for (int bi = 0; bi < nb; ++bi) d[bi] += nc[bi];
+                    rowAdd(d, cRow(e.first), nb);
                     cnt += 1.0f;
                 }
-                const float inv = 1.0f / cnt;
-                for (int bi = 0; bi < nb; ++bi) d[bi] *= inv;
+                rowMul(d, 1.0f / cnt, nb);
             }
             Cf.swap(tmp);
         }
@@ -2904,21 +2992,19 @@ bool AutoRigPlugin::computeSkinWeights() {
     // foot into the other; it only blends bones that already meet on the limb.
     {
         const int kWeightSmoothPasses = 4;
-        std::vector<std::vector<float>> tmp(W);
+        std::vector<float> tmp(Wf.size());
         for (int pass = 0; pass < kWeightSmoothPasses; ++pass) {
             for (int w = 0; w < W; ++w) {
-                if (!isSkin[w]) { tmp[w] = Wf[w]; continue; }
-                std::vector<float> d = Wf[w];
+                float* d = tmp.data() + static_cast<size_t>(w) * NB;
+                std::copy_n(wRow(w), nb, d);
+                if (!isSkin[w]) continue;
                 float cnt = 1.0f;
                 for (const auto& e : adj[w]) {
                     if (!isSkin[e.first]) continue;
-                    const std::vector<float>& nw = Wf[e.first];
-                    for (int bi = 0; bi < nb; ++bi) d[bi] += nw[bi];
+                    rowAdd(d, wRow(e.first), nb);
                     cnt += 1.0f;
                 }
-                const float inv = 1.0f / cnt;
-                for (int bi = 0; bi < nb; ++bi) d[bi] *= inv;
-                tmp[w] = std::move(d);
+                rowMul(d, 1.0f / cnt, nb);
             }
             Wf.swap(tmp);
         }
@@ -2942,26 +3028,23 @@ bool AutoRigPlugin::computeSkinWeights() {
             if (!isSkin[w] && !projAnchor[w] && !adjOuter[w].empty())
                 freeV.push_back(w);
         if (!freeV.empty()) {
-            std::vector<std::vector<float>> tmp = Wf;
+            // Jacobi: new rows go to a per-free-vertex buffer, then back.
+            std::vector<float> tmp(freeV.size() * NB);
             for (int pass = 0; pass < kFillPasses; ++pass) {
-                for (int w : freeV) {
-                    std::vector<float>& d = tmp[w];
-                    for (int bi = 0; bi < nb; ++bi) d[bi] = 0.0f;
+                for (size_t f = 0; f < freeV.size(); ++f) {
+                    const int w = freeV[f];
+                    float* d = tmp.data() + f * NB;
+                    std::fill_n(d, nb, 0.0f);
                     float cnt = 0.0f;
                     for (const auto& e : adjOuter[w]) {
-                        const std::vector<float>& nw2 = Wf[e.first];
-                        for (int bi = 0; bi < nb; ++bi) d[bi] += nw2[bi];
+                        rowAdd(d, wRow(e.first), nb);
                         cnt += 1.0f;
                     }
-                    if (cnt > 0.0f) {
-                        const float inv = 1.0f / cnt;
-                        for (int bi = 0; bi < nb; ++bi) d[bi] *= inv;
-                    } else {
-                        const std::vector<float>& s = Wf[w];
-                        for (int bi = 0; bi < nb; ++bi) d[bi] = s[bi];
-                    }
+                    if (cnt > 0.0f) rowMul(d, 1.0f / cnt, nb);
+                    else            std::copy_n(wRow(w), nb, d);
                 }
-                for (int w : freeV) Wf[w].swap(tmp[w]);
+                for (size_t f = 0; f < freeV.size(); ++f)
+                    std::copy_n(tmp.data() + f * NB, nb, wRow(freeV[f]));
             }
         }
     }
@@ -2981,22 +3064,21 @@ bool AutoRigPlugin::computeSkinWeights() {
         for (int w = 0; w < W; ++w)
             if (!isSkin[w] && !adjOuter[w].empty()) outer.push_back(w);
         if (!outer.empty()) {
-            std::vector<std::vector<float>> tmp = Wf;
+            std::vector<float> tmp(outer.size() * NB);
             for (int pass = 0; pass < kClothSmoothPasses; ++pass) {
-                for (int w : outer) {
-                    std::vector<float>& d = tmp[w];
-                    const std::vector<float>& s = Wf[w];
-                    for (int bi = 0; bi < nb; ++bi) d[bi] = s[bi];
+                for (size_t o = 0; o < outer.size(); ++o) {
+                    const int w = outer[o];
+                    float* d = tmp.data() + o * NB;
+                    std::copy_n(wRow(w), nb, d);
                     float cnt = 1.0f;
                     for (const auto& e : adjOuter[w]) {
-                        const std::vector<float>& nw2 = Wf[e.first];
-                        for (int bi = 0; bi < nb; ++bi) d[bi] += nw2[bi];
+                        rowAdd(d, wRow(e.first), nb);
                         cnt += 1.0f;
                     }
-                    const float inv = 1.0f / cnt;
-                    for (int bi = 0; bi < nb; ++bi) d[bi] *= inv;
+                    rowMul(d, 1.0f / cnt, nb);
                 }
-                for (int w : outer) Wf[w].swap(tmp[w]);
+                for (size_t o = 0; o < outer.size(); ++o)
+                    std::copy_n(tmp.data() + o * NB, nb, wRow(outer[o]));
             }
         }
     }
@@ -3021,30 +3103,27 @@ bool AutoRigPlugin::computeSkinWeights() {
     {
         const int   kPostBlendPasses = 10;
         const float kEps             = 1e-8f;
-        std::vector<std::vector<float>> tmp(W);
+        std::vector<float> tmp(Wf.size());
         auto blendOnce =
             [&](const std::vector<std::vector<std::pair<int, float>>>& graph,
                 bool want_skin) {
                 for (int w = 0; w < W; ++w) {
-                    if ((bool)isSkin[w] != want_skin) { tmp[w] = Wf[w]; continue; }
-                    if (graph[w].empty())             { tmp[w] = Wf[w]; continue; }
-                    std::vector<float> d = Wf[w];         // self
+                    float* d = tmp.data() + static_cast<size_t>(w) * NB;
+                    std::copy_n(wRow(w), nb, d);          // self
+                    if ((bool)isSkin[w] != want_skin) continue;
+                    if (graph[w].empty())             continue;
                     float cnt = 1.0f;
                     for (const auto& e : graph[w]) {
                         // Only blend with neighbours of the SAME layer class so
                         // the skin/cloth boundary is never crossed here.
                         if ((bool)isSkin[e.first] != want_skin) continue;
-                        const std::vector<float>& nw = Wf[e.first];
-                        for (int bi = 0; bi < nb; ++bi) d[bi] += nw[bi];
+                        rowAdd(d, wRow(e.first), nb);
                         cnt += 1.0f;
                     }
+                    rowDiv(d, cnt, nb);
                     float s = 0.0f;
-                    for (int bi = 0; bi < nb; ++bi) { d[bi] /= cnt; s += d[bi]; }
-                    if (s > kEps) {                       // project onto sum==1
-                        const float inv = 1.0f / s;
-                        for (int bi = 0; bi < nb; ++bi) d[bi] *= inv;
-                    }
-                    tmp[w] = std::move(d);
+                    for (int bi = 0; bi < nb; ++bi) s += d[bi];
+                    if (s > kEps) rowMul(d, 1.0f / s, nb);   // project onto sum==1
                 }
                 Wf.swap(tmp);
             };
@@ -3059,22 +3138,15 @@ bool AutoRigPlugin::computeSkinWeights() {
     // inheritance, then Laplacian-smoothed).  Per vertex we keep the K
     // (= kMaxVertexInfluences, 8 for the 8-bone debug path) strongest bones
     // and normalize.  Anything still empty (no skin at all) is counted.
+    // The kept bones go straight into the packed (unorm16) table, which does
+    // the final exact renormalization.
     constexpr int K = kMaxVertexInfluences;
     size_t unweighted_count = 0;
+    skin_weights_.reset(nj, /*keep_closeness=*/true, static_cast<size_t>(nv));
     for (int v = 0; v < nv; ++v) {
-        const std::vector<float>& wv = Wf[wid[v]];
-        auto& vsd = skin_weights_.per_vertex[v];
+        int   vj[K]; float vw[K], vc[K];
         int   idx[K]; float val[K];
-        for (int i = 0; i < K; ++i) { idx[i] = -1; val[i] = 0.0f; }
-        for (int bi = 0; bi < nb; ++bi) {
-            const float wgt = wv[bi];
-            if (wgt <= 0.0f) continue;                    // only bones that reached it
-            for (int s = 0; s < K; ++s)                   // insertion into the top-K
-                if (wgt > val[s]) {
-                    for (int t = K - 1; t > s; --t) { val[t] = val[t-1]; idx[t] = idx[t-1]; }
-                    val[s] = wgt; idx[s] = bi; break;
-                }
-        }
+        rowTopK<K>(wRow(wid[v]), nb, idx, val);          // only bones that reached it
         // Relative cut: keep the dominant bone (val[0]) plus only those within
         // kKeepFrac of it; drop the far, exponentially-weaker bones.  This
         // LOCALIZES each vertex to its geodesically-closest bones (clean blend)
@@ -3098,20 +3170,20 @@ bool AutoRigPlugin::computeSkinWeights() {
         float total = 0.0f;
         for (int i = 0; i < K; ++i) {
             if (idx[i] < 0 || val[i] <= 0.0f) {
-                vsd.joint_indices[i] = 0; vsd.weights[i] = 0.0f;
-                vsd.closeness[i] = 0.0f; continue;
+                vj[i] = -1; vw[i] = 0.0f; vc[i] = 0.0f; continue;
             }
-            vsd.joint_indices[i] = bones[idx[i]].joint_idx;
-            vsd.weights[i] = val[i];
+            vj[i] = bones[idx[i]].joint_idx;
+            vw[i] = val[i];
             // RAW preview-mode closeness for this bone — NOT the smoothed /
             // truncated weight.  The Dist debug view displays this verbatim,
             // so it matches the preview's live distance computation.
-            vsd.closeness[i] = Cf[wid[v]][idx[i]];
+            vc[i] = cRow(wid[v])[idx[i]];
             total += val[i];
         }
         if (total > 1e-8f) {
-            for (int i = 0; i < K; ++i) vsd.weights[i] /= total;   // partition of unity
+            skin_weights_.appendVertex(vj, vw, vc, K);   // partition of unity
         } else {
+            skin_weights_.appendVertex(vj, vw, vc, 0);
             ++unweighted_count;   // no skin at all to inherit from (degenerate)
         }
     }
@@ -3447,58 +3519,41 @@ bool AutoRigPlugin::exportGltf(const std::string& output_path) {
     //  Must match the vertex count we computed skin weights for.
     size_t total_verts = mesh_.positions.size();
 
-    // ---- Joint indices (JOINTS_0 + JOINTS_1: uvec4 as unsigned short) ------
+    // ---- Joint indices (JOINTS_0 + JOINTS_1: uvec4) -------------------------
     //  kMaxVertexInfluences (8) influences per vertex, split into two glTF
     //  skin sets of 4 (set 1 = influences 4..7) for the 8-bone debug path.
+    //  Unsigned byte for skeletons of <= 256 joints, unsigned short otherwise.
     static_assert(kMaxVertexInfluences == 8,
                   "glb export assumes exactly two vec4 skin sets");
-    std::vector<uint16_t> joint_data(total_verts * 4, 0);
-    std::vector<uint16_t> joint_data1(total_verts * 4, 0);
-    for (size_t v = 0; v < total_verts; ++v) {
-        for (int i = 0; i < 4; ++i) {
-            joint_data[v * 4 + i] = static_cast<uint16_t>(
-                skin_weights_.per_vertex[v].joint_indices[i]);
-            joint_data1[v * 4 + i] = static_cast<uint16_t>(
-                skin_weights_.per_vertex[v].joint_indices[4 + i]);
-        }
-    }
-    size_t joints_offset = appendData(
-        joint_data.data(), joint_data.size() * sizeof(uint16_t));
-    size_t joints_size = joint_data.size() * sizeof(uint16_t);
-    size_t joints1_offset = appendData(
-        joint_data1.data(), joint_data1.size() * sizeof(uint16_t));
-    size_t joints1_size = joint_data1.size() * sizeof(uint16_t);
-
-    // ---- Weights (WEIGHTS_0 + WEIGHTS_1: vec4 float) -----------------------
-    std::vector<float> weight_data(total_verts * 4, 0.0f);
-    std::vector<float> weight_data1(total_verts * 4, 0.0f);
-    for (size_t v = 0; v < total_verts; ++v) {
-        for (int i = 0; i < 4; ++i) {
-            weight_data[v * 4 + i] = skin_weights_.per_vertex[v].weights[i];
-            weight_data1[v * 4 + i] =
-                skin_weights_.per_vertex[v].weights[4 + i];
-        }
-    }
+    const int joint_comp = skin_weights_.gltfJointBytes() == 1
+        ? TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE
+        : TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT;
+    const size_t joint_elem = static_cast<size_t>(skin_weights_.gltfJointBytes());
+    std::vector<uint8_t> joint_data  = skin_weights_.gltfJoints(0, total_verts);
+    std::vector<uint8_t> joint_data1 = skin_weights_.gltfJoints(1, total_verts);
+    size_t joints_offset = appendData(joint_data.data(), joint_data.size());
+    size_t joints_size = joint_data.size();
+    size_t joints1_offset = appendData(joint_data1.data(), joint_data1.size());
+    size_t joints1_size = joint_data1.size();
+
+    // ---- Weights (WEIGHTS_0 + WEIGHTS_1: vec4 normalized unsigned short) ---
+    //  The packed unorm16 weights verbatim: lossless, and each vertex sums to
+    //  exactly 65535 across both sets, as glTF requires.
+    std::vector<uint16_t> weight_data  = skin_weights_.gltfWeights(0, total_verts);
+    std::vector<uint16_t> weight_data1 = skin_weights_.gltfWeights(1, total_verts);
     size_t weights_offset = appendData(
-        weight_data.data(), weight_data.size() * sizeof(float));
-    size_t weights_size = weight_data.size() * sizeof(float);
+        weight_data.data(), weight_data.size() * sizeof(uint16_t));
+    size_t weights_size = weight_data.size() * sizeof(uint16_t);
     size_t weights1_offset = appendData(
-        weight_data1.data(), weight_data1.size() * sizeof(float));
-    size_t weights1_size = weight_data1.size() * sizeof(float);
+        weight_data1.data(), weight_data1.size() * sizeof(uint16_t));
+    size_t weights1_size = weight_data1.size() * sizeof(uint16_t);
 
     // ---- Closeness (_CLOSENESS_0/_CLOSENESS_1: vec4 float, custom) ---------
     //  Baked distance-derived closeness for the same joints (pre-normalize),
     //  so the debug display renders the auto-rig's own distance field instead
     //  of recomputing it.  Rides through as custom glTF vertex attributes.
-    std::vector<float> close_data(total_verts * 4, 0.0f);
-    std::vector<float> close_data1(total_verts * 4, 0.0f);
-    for (size_t v = 0; v < total_verts; ++v) {
-        for (int i = 0; i < 4; ++i) {
-            close_data[v * 4 + i] = skin_weights_.per_vertex[v].closeness[i];
-            close_data1[v * 4 + i] =
-                skin_weights_.per_vertex[v].closeness[4 + i];
-        }
-    }
+    std::vector<float> close_data  = skin_weights_.gltfCloseness(0, total_verts);
+    std::vector<float> close_data1 = skin_weights_.gltfCloseness(1, total_verts);
     size_t close_offset = appendData(
         close_data.data(), close_data.size() * sizeof(float));
     size_t close_size = close_data.size() * sizeof(float);
@@ -3550,10 +3605,11 @@ bool AutoRigPlugin::exportGltf(const std::string& output_path) {
         return idx;
     };
 
-    int acc_joints  = addAcc(bv_joints, TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT,
+    int acc_joints  = addAcc(bv_joints, joint_comp,
                              TINYGLTF_TYPE_VEC4, total_verts);
-    int acc_weights = addAcc(bv_weights, TINYGLTF_COMPONENT_TYPE_FLOAT,
+    int acc_weights = addAcc(bv_weights, TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT,
                              TINYGLTF_TYPE_VEC4, total_verts);
+    out.accessors[acc_weights].normalized = true;
     int acc_ibm     = addAcc(bv_ibm, TINYGLTF_COMPONENT_TYPE_FLOAT,
                              TINYGLTF_TYPE_MAT4, skeleton_.joints.size());
 
@@ -3578,11 +3634,12 @@ bool AutoRigPlugin::exportGltf(const std::string& output_path) {
 
                 // Helper: per-primitive accessor over a vertex slice.
                 auto addPrimAcc = [&](int bv, int comp_type, size_t elem_sz,
-                                      const char* attr) {
+                                      const char* attr, bool normalized = false) {
                     tinygltf::Accessor acc;
                     acc.bufferView    = bv;
                     acc.byteOffset    = vertex_offset * 4 * elem_sz;
                     acc.componentType = comp_type;
+                    acc.normalized    = normalized;
                     acc.type          = TINYGLTF_TYPE_VEC4;
                     acc.count         = prim_verts;
                     int idx = static_cast<int>(out.accessors.size());
@@ -3591,14 +3648,12 @@ bool AutoRigPlugin::exportGltf(const std::string& output_path) {
                 };
 
                 // Skin set 0 (influences 0..3) + set 1 (influences 4..7).
-                addPrimAcc(bv_joints, TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT,
-                           sizeof(uint16_t), "JOINTS_0");
-                addPrimAcc(bv_joints1, TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT,
-                           sizeof(uint16_t), "JOINTS_1");
-                addPrimAcc(bv_weights, TINYGLTF_COMPONENT_TYPE_FLOAT,
-                           sizeof(float), "WEIGHTS_0");
-                addPrimAcc(bv_weights1, TINYGLTF_COMPONENT_TYPE_FLOAT,
-                           sizeof(float), "WEIGHTS_1");
+                addPrimAcc(bv_joints, joint_comp, joint_elem, "JOINTS_0");
+                addPrimAcc(bv_joints1, joint_comp, joint_elem, "JOINTS_1");
+                addPrimAcc(bv_weights, TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT,
+                           sizeof(uint16_t), "WEIGHTS_0", /*normalized=*/true);
+                addPrimAcc(bv_weights1, TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT,
+                           sizeof(uint16_t), "WEIGHTS_1", /*normalized=*/true);
                 addPrimAcc(bv_close, TINYGLTF_COMPONENT_TYPE_FLOAT,
                            sizeof(float), "_CLOSENESS_0");
                 addPrimAcc(bv_close1, TINYGLTF_COMPONENT_TYPE_FLOAT,
@@ -3773,7 +3828,7 @@ bool AutoRigPlugin::generateJoints() {
     joints_generated_ = false;
     joints_edited_    = false;
     weights_baked_    = false;
-    skin_weights_     = SkinWeights{};  // drop any stale weights
+    skin_weights_     = PackedSkinWeights{};  // drop any stale weights
     weight_view_mode_ = 0;
     edit3d_render_.width = 0;            // force editor re-render
     edit3d_drag_joint_  = -1;
@@ -4760,7 +4815,7 @@ static ImU32 boneColor(int j) {
 }
 
 // Color for one vertex from its skin weights, in the chosen mode.
-static void weightVertexColor(const VertexSkinData& vsd, int mode,
+static void weightVertexColor(const PackedSkinWeights& sw, size_t v, int mode,
                               float& r, float& g, float& b) {
     r = g = b = 0.0f;
     // Mode 1: eight fixed slot colors (R, G, B, yellow, magenta, cyan,
@@ -4768,13 +4823,14 @@ static void weightVertexColor(const VertexSkinData& vsd, int mode,
     static const float kSlot[kMaxVertexInfluences][3] = {
         {1,0.2f,0.2f}, {0.2f,1,0.2f}, {0.3f,0.5f,1}, {1,0.85f,0.15f},
         {1,0.2f,1},    {0.2f,1,1},    {1,0.55f,0.1f}, {0.9f,0.9f,0.9f} };
-    for (int k = 0; k < kMaxVertexInfluences; ++k) {
-        float w = vsd.weights[k];
-        if (w <= 0.0f) continue;
+    const uint32_t first = sw.begin(v);
+    for (uint32_t e = first; e < sw.end(v); ++e) {
+        const int   k = static_cast<int>(e - first);
+        const float w = sw.weightOf(e);
         if (mode == 1) {
             r += w * kSlot[k][0]; g += w * kSlot[k][1]; b += w * kSlot[k][2];
         } else {  // mode 2: per-bone palette
-            ImU32 c = boneColor(vsd.joint_indices[k]);
+            ImU32 c = boneColor(sw.joint(e));
             r += w * ((c >> IM_COL32_R_SHIFT) & 0xFF) / 255.0f;
             g += w * ((c >> IM_COL32_G_SHIFT) & 0xFF) / 255.0f;
             b += w * ((c >> IM_COL32_B_SHIFT) & 0xFF) / 255.0f;
@@ -4786,7 +4842,7 @@ static bool drawModel3DPreview(
     const TriangleMesh& mesh, const Skeleton& skeleton,
     float canvas_size, ImVec2 canvas_pos, ImDrawList* dl,
     float& yaw, float& pitch, bool& dragging, ImVec2& drag_start,
-    const SkinWeights* weights = nullptr, int weight_mode = 0,
+    const PackedSkinWeights* weights = nullptr, int weight_mode = 0,
     const std::vector<float>* joint_tau = nullptr, bool show_tau = false)
 {
     // Dark background.
@@ -4829,7 +4885,7 @@ static bool drawModel3DPreview(
         size_t tri_count = mesh.indices.size() / 3;
         size_t step = std::max<size_t>(1, tri_count / 800);
         const bool show_w = (weight_mode > 0 && weights &&
-                             weights->per_vertex.size() == mesh.positions.size());
+                             weights->numVertices() == mesh.positions.size());
         for (size_t t = 0; t < tri_count; t += step) {
             uint32_t i0 = mesh.indices[t * 3 + 0];
             uint32_t i1 = mesh.indices[t * 3 + 1];
@@ -4841,7 +4897,7 @@ static bool drawModel3DPreview(
                 // Average the 3 vertices' weight-colors for a flat-shaded tri.
                 float r = 0, g = 0, b = 0, rr, gg, bb;
                 for (uint32_t idx : { i0, i1, i2 }) {
-                    weightVertexColor(weights->per_vertex[idx], weight_mode, rr, gg, bb);
+                    weightVertexColor(*weights, idx, weight_mode, rr, gg, bb);
                     r += rr; g += gg; b += bb;
                 }
                 ImU32 col = IM_COL32(
@@ -5020,8 +5076,10 @@ void AutoRigPlugin::drawJointEditor3D(float canvas_size) {
         std::abs(camera_distance_ - edit3d_render_dist_) > 0.0001f ||
         std::abs(edit3d_opacity_  - edit3d_render_op_)   > 0.001f;
     if (needs_render) {
+        rasterizer_->recycle(std::move(edit3d_render_));
         edit3d_render_ = rasterizer_->renderOIT(
-            mesh_, res, res, view_mat, proj, edit3d_opacity_, az, el);
+            mesh_, res, res, view_mat, proj, edit3d_opacity_, az, el,
+            /*sample_texture=*/true);
         edit3d_render_yaw_   = preview_yaw_;
         edit3d_render_pitch_ = preview_pitch_;
         edit3d_render_dist_  = camera_distance_;
@@ -5280,6 +5338,7 @@ void AutoRigPlugin::drawMeshSelector(int& sel_idx, std::string& sel_path,
                         std::snprintf(output_path_buf_, sizeof(output_path_buf_), "%s", out.string().c_str());
                         if (mesh_.empty() || source_mesh_path_ != sel_path) {
                             loadMesh(sel_path);
+                            rasterizer_->recycle(std::move(captures_));
                             captures_ = rasterizer_->captureOrbit(
                                 mesh_, num_views_, capture_resolution_, 0.0f, camera_distance_);
                             initEditableJoints();
@@ -6241,7 +6300,7 @@ void AutoRigPlugin::drawAutoRigWorkflowWindow() {
                         ImGui::TreePop();
                     }
                 }
-                if (!skin_weights_.empty()) ImGui::Text("Skin: %d verts", (int)skin_weights_.per_vertex.size());
+                if (!skin_weights_.empty()) ImGui::Text("Skin: %d verts (%zu KB)", (int)skin_weights_.numVertices(), skin_weights_.bytes() / 1024);
                 if (!mesh_.empty()) ImGui::Text("Mesh: %zuk tris", mesh_.indices.size() / 3000);
 
                 // Skin-weight overlay controls.
@@ -6485,9 +6544,10 @@ void AutoRigPlugin::drawRigEditorWindow() {
                     eye.z = centre.z + radius * cosf(el_rad) * sinf(az_rad);
                     glm::mat4 view_mat = glm::lookAt(eye, centre, glm::vec3(0, 1, 0));
 
+                    rasterizer_->recycle(std::move(preview_render_));
                     preview_render_ = rasterizer_->render(
                         re_mesh_, render_res, render_res,
-                        view_mat, proj, az, el);
+                        view_mat, proj, az, el, /*sample_texture=*/true);
                     preview_render_yaw_   = preview_yaw_;
                     preview_render_pitch_ = preview_pitch_;
                 }
@@ -6566,6 +6626,7 @@ void AutoRigPlugin::drawRigEditorWindow() {
                 // Render with OIT for translucent mesh (joints visible behind body).
                 // Training data export uses the color PNG from this capture, which
                 // is opaque; OIT only affects the interactive editing overlay.
+                rasterizer_->recycle(std::move(edit_capture_));
                 edit_capture_ = rasterizer_->renderOIT(
                     re_mesh_, capture_resolution_, capture_resolution_,
                     view_mat, proj, mesh_opacity_, az, el);
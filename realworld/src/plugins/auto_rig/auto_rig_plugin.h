@@ -3,6 +3,8 @@
 #include "plugins/auto_rig/simple_rasterizer.h"
 #include "plugins/auto_rig/rig_diffusion_model.h"
 #include "plugins/auto_rig/rig_types.h"
+#include "plugins/auto_rig/mesh_topology.h"
+#include "plugins/auto_rig/packed_skin_weights.h"
 #include <string>
 #include <vector>
 #include <memory>
@@ -83,7 +85,7 @@ public:
 
     // Accessors.
     const Skeleton&    getSkeleton()    const { return skeleton_; }
-    const SkinWeights& getSkinWeights() const { return skin_weights_; }
+    const PackedSkinWeights& getSkinWeights() const { return skin_weights_; }
     const std::vector<ViewCapture>& getCaptures() const { return captures_; }
     // Per-vertex base-skin classification (1 = base skin), for the Debug Display.
     const std::vector<uint8_t>& getBaseSkinVerts() const { return base_skin_vert_; }
@@ -128,6 +130,10 @@ private:
     std::string     source_mesh_path_;   // original file — reloaded at export time
     TriangleMesh    mesh_;
     glm::mat4       mesh_node_world_transform_ = glm::mat4(1.0f);  // world xform of the mesh node
+    // Weld / components / edge graph of mesh_, built on first use and shared
+    // by every bake.  loadMesh() drops it; nothing else edits mesh_ geometry.
+    std::shared_ptr<const MeshTopology> mesh_topology_;
+    const MeshTopology& meshTopology();
     int             detected_up_axis_ = 1;  // 0=X, 1=Y, 2=Z  (auto-detected from bbox)
 
     // Independent mesh for the 2D Rig Editor window — kept fully separate from
@@ -148,8 +154,8 @@ private:
     std::vector<ViewJointPrediction>   view_predictions_;
 
     // Final outputs.
-    Skeleton    skeleton_;
-    SkinWeights skin_weights_;
+    Skeleton          skeleton_;
+    PackedSkinWeights skin_weights_;
 
     // Scan asset directories for mesh files.
     void refreshMeshFileList();
@@ -0,0 +1,276 @@
+// ============================================================================
+//  mesh_topology.cpp  —  see header for the high-level description.
+// ============================================================================
+
+#include "plugins/auto_rig/mesh_topology.h"
+#include "plugins/auto_rig/parallel_for.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace plugins {
+namespace auto_rig {
+
+namespace {
+
+constexpr int kWeldChunk = 16384;                // vertices / edges per parallel item
+
+// Stable LSD radix sort of (keys, vals) by the low `bits` bits of the key,
+// 16 bits per pass.
+template <class V>
+void radixSortByKey(std::vector<uint64_t>& keys, std::vector<V>& vals, int bits) {
+    const size_t n = keys.size();
+    std::vector<uint64_t> k2(n);
+    std::vector<V>        v2(n);
+    std::vector<size_t>   count(1u << 16);
+    for (int shift = 0; shift < bits; shift += 16) {
+        std::fill(count.begin(), count.end(), 0);
+        for (size_t i = 0; i < n; ++i) ++count[(keys[i] >> shift) & 0xFFFF];
+        size_t sum = 0;
+        for (auto& c : count) { const size_t t = c; c = sum; sum += t; }
+        for (size_t i = 0; i < n; ++i) {
+            const size_t dst = count[(keys[i] >> shift) & 0xFFFF]++;
+            k2[dst] = keys[i];
+            v2[dst] = vals[i];
+        }
+        keys.swap(k2);
+        vals.swap(v2);
+    }
+}
+
+}  // namespace
+
+MeshTopology buildMeshTopology(const TriangleMesh& mesh) {
+    MeshTopology topo;
+    const int nv = static_cast<int>(mesh.positions.size());
+    topo.nv = nv;
+    if (nv == 0) return topo;
+
+    // Valid triangles only (corner indices inside the vertex array).
+    std::vector<glm::ivec3> otris;
+    otris.reserve(mesh.indices.size() / 3);
+    for (size_t t = 0; t + 2 < mesh.indices.size(); t += 3) {
+        const uint32_t a = mesh.indices[t], b = mesh.indices[t + 1],
+                       c = mesh.indices[t + 2];
+        if (a >= (uint32_t)nv || b >= (uint32_t)nv || c >= (uint32_t)nv) continue;
+        otris.push_back({ (int)a, (int)b, (int)c });
+    }
+
+    // ── Weld by MANIFOLD EDGE matching ──
+    // Two vertices are merged ONLY when they are the endpoints of a COINCIDENT
+    // triangle EDGE — the seam where two triangles of the SAME surface meet.
+    // A plain spatial-cell weld fuses separate parts that merely touch (the
+    // two feet, whose same-facing soles share grid cells), inventing geodesic
+    // shortcuts; two such pieces share no tessellated edge, so they stay
+    // separate islands here.
+    //
+    // Everything is sort-based: vertices are radix-sorted by cell key and
+    // numbered by a linear scan over equal-key runs, the edges are radix-sorted
+    // by their (cell, cell) pair, and each run of coincident edges is stitched
+    // through a lock-free union-find in parallel.  The welded classes do not
+    // depend on the order the unions happen in, so the result is the same as a
+    // serial pass in triangle order.
+    glm::vec3 lo(1e30f), hi(-1e30f);
+    for (const auto& p : mesh.positions) { lo = glm::min(lo, p); hi = glm::max(hi, p); }
+    const double weld_eps = std::max((double)glm::length(hi - lo) * 1e-4, 1e-9);
+    auto cellKey = [weld_eps](const glm::vec3& p) -> uint64_t {
+        uint64_t h = 1469598103934665603ull;
+        for (int i = 0; i < 3; ++i) {
+            const int64_t qi = (int64_t)std::llround((double)p[i] / weld_eps);
+            h ^= (uint64_t)qi; h *= 1099511628211ull;
+        }
+        return h;
+    };
+    const int nchunks = (nv + kWeldChunk - 1) / kWeldChunk;
+    std::vector<uint64_t> keys(nv);
+    parallelFor(nchunks, [&](int c) {
+        const int i1 = std::min(nv, (c + 1) * kWeldChunk);
+        for (int i = c * kWeldChunk; i < i1; ++i) keys[i] = cellKey(mesh.positions[i]);
+    });
+
+    // Dense cell id per vertex: equal keys are adjacent after the sort.
+    std::vector<int> vcell(nv);
+    int ncell = 0;
+    {
+        std::vector<int> order(nv);
+        for (int i = 0; i < nv; ++i) order[i] = i;
+        radixSortByKey(keys, order, 64);
+        for (int k = 0; k < nv; ++k) {
+            if (k > 0 && keys[k] != keys[k - 1]) ++ncell;
+            vcell[order[k]] = ncell;
+        }
+        ++ncell;
+    }
+
+    // Non-degenerate edges keyed by their unordered cell pair.  The stable
+    // sort keeps each run in triangle order, so a run's first edge is the one
+    // that first claimed the spatial edge.
+    auto edgeEnds = [&](uint32_t e) -> std::pair<int, int> {
+        const glm::ivec3& t = otris[e / 3];
+        switch (e % 3) {
+            case 0:  return { t.x, t.y };
+            case 1:  return { t.y, t.z };
+            default: return { t.z, t.x };
+        }
+    };
+    std::vector<uint64_t> ekeys;
+    std::vector<uint32_t> edges;
+    ekeys.reserve(otris.size() * 3);
+    edges.reserve(otris.size() * 3);
+    for (uint32_t e = 0; e < otris.size() * 3; ++e) {
+        const std::pair<int, int> ab = edgeEnds(e);
+        const uint64_t ca = (uint64_t)vcell[ab.first], cb = (uint64_t)vcell[ab.second];
+        if (ca == cb) continue;                          // degenerate edge
+        ekeys.push_back(std::min(ca, cb) * (uint64_t)ncell + std::max(ca, cb));
+        edges.push_back(e);
+    }
+    radixSortByKey(ekeys, edges,
+                   static_cast<int>(std::bit_width((uint64_t)ncell * (uint64_t)ncell - 1)));
+
+    // Lock-free union-find: roots are linked larger-index-under-smaller with a
+    // CAS, finds halve paths with relaxed CASes.
+    std::vector<std::atomic<int>> uf(nv);
+    for (int i = 0; i < nv; ++i) uf[i].store(i, std::memory_order_relaxed);
+    auto ufFind = [&](int x) {
+        for (;;) {
+            int p = uf[x].load(std::memory_order_relaxed);
+            if (p == x) return x;
+            const int gp = uf[p].load(std::memory_order_relaxed);
+            if (gp != p) uf[x].compare_exchange_weak(p, gp, std::memory_order_relaxed);
+            x = gp;
+        }
+    };
+    auto ufUnion = [&](int a, int b) {
+        for (;;) {
+            a = ufFind(a); b = ufFind(b);
+            if (a == b) return;
+            if (a < b) std::swap(a, b);
+            int expected = a;
+            if (uf[a].compare_exchange_strong(expected, b, std::memory_order_acq_rel)) return;
+        }
+    };
+    // Each chunk stitches the runs that START inside it.
+    const int ne = static_cast<int>(edges.size());
+    parallelFor((ne + kWeldChunk - 1) / kWeldChunk, [&](int c) {
+        const int k1 = std::min(ne, (c + 1) * kWeldChunk);
+        int k = c * kWeldChunk;
+        while (k > 0 && k < k1 && ekeys[k] == ekeys[k - 1]) ++k;
+        while (k < k1) {
+            const std::pair<int, int> r = edgeEnds(edges[k]);
+            int j = k + 1;
+            for (; j < ne && ekeys[j] == ekeys[k]; ++j) {
+                const std::pair<int, int> ab = edgeEnds(edges[j]);
+                if (vcell[ab.first] == vcell[r.first]) { ufUnion(ab.first, r.first); ufUnion(ab.second, r.second); }
+                else                                   { ufUnion(ab.first, r.second); ufUnion(ab.second, r.first); }
+            }
+            k = j;
+        }
+    });
+
+    // Compact union-find roots into dense welded ids (first-seen order).
+    std::vector<int> root(nv);
+    parallelFor(nchunks, [&](int c) {
+        const int i1 = std::min(nv, (c + 1) * kWeldChunk);
+        for (int i = c * kWeldChunk; i < i1; ++i) root[i] = ufFind(i);
+    });
+    topo.wid.resize(nv);
+    {
+        std::vector<int> root2id(nv, -1);
+        for (int i = 0; i < nv; ++i) {
+            int& id = root2id[root[i]];
+            if (id < 0) {
+                id = static_cast<int>(topo.wpos.size());
+                topo.wpos.push_back(mesh.positions[i]);
+            }
+            topo.wid[i] = id;
+        }
+    }
+    const int W = static_cast<int>(topo.wpos.size());
+    topo.num_welded = W;
+
+    topo.tris.reserve(otris.size());
+    for (const auto& t : otris)
+        topo.tris.push_back({ topo.wid[t.x], topo.wid[t.y], topo.wid[t.z] });
+
+    // ── Connected components over the welded surface ──
+    auto& comp = topo.comp;
+    comp.resize(W);
+    for (int i = 0; i < W; ++i) comp[i] = i;
+    auto findc = [&](int x) {
+        while (comp[x] != x) { comp[x] = comp[comp[x]]; x = comp[x]; }
+        return x;
+    };
+    auto unite = [&](int a, int b) { comp[findc(a)] = findc(b); };
+    for (const auto& t : topo.tris) { unite(t.x, t.y); unite(t.y, t.z); }
+    for (int i = 0; i < W; ++i) comp[i] = findc(i);
+    topo.comp_index.assign(W, -1);
+    {
+        std::vector<int> label(W, -1);                   // representative -> label
+        for (int i = 0; i < W; ++i) {
+            int& l = label[comp[i]];
+            if (l < 0) l = topo.num_components++;
+            topo.comp_index[i] = l;
+        }
+    }
+
+    // ── Edge graph + cotangent weights + lumped areas ──
+    // Every triangle emits its six directed (row, col, cotan/2) entries; one
+    // stable sort groups them by (row, col) and duplicates are summed in
+    // triangle order.  The merged list IS the CSR layout.
+    struct Entry {
+        uint64_t key;                                    // row << 32 | col
+        double   w;                                      // half cotangent
+    };
+    using dvec3 = glm::dvec3;
+    auto cotAt = [](const dvec3& v, const dvec3& a, const dvec3& b) {
+        dvec3 e0 = a - v, e1 = b - v;
+        double cr = glm::length(glm::cross(e0, e1));
+        if (cr < 1e-15) return 0.0;
+        return glm::dot(e0, e1) / cr;
+    };
+    topo.mass.assign(W, 0.0);
+    std::vector<Entry> entries;
+    entries.reserve(topo.tris.size() * 6);
+    auto emit = [&](int i, int j, double w) {
+        if (i == j) return;
+        entries.push_back({ (uint64_t(uint32_t(i)) << 32) | uint32_t(j), w });
+        entries.push_back({ (uint64_t(uint32_t(j)) << 32) | uint32_t(i), w });
+    };
+    for (const auto& t : topo.tris) {
+        const int a = t.x, b = t.y, c = t.z;
+        dvec3 pa(topo.wpos[a]), pb(topo.wpos[b]), pc(topo.wpos[c]);
+
+        double area = 0.5 * glm::length(glm::cross(pb - pa, pc - pa));
+        double third = area / 3.0;
+        topo.mass[a] += third; topo.mass[b] += third; topo.mass[c] += third;
+
+        // cotan(angle at X) weights the OPPOSITE edge.
+        emit(b, c, 0.5 * cotAt(pa, pb, pc));
+        emit(c, a, 0.5 * cotAt(pb, pc, pa));
+        emit(a, b, 0.5 * cotAt(pc, pa, pb));
+    }
+    std::stable_sort(entries.begin(), entries.end(),
+                     [](const Entry& x, const Entry& y) { return x.key < y.key; });
+
+    topo.adj_ptr.assign(W + 1, 0);
+    for (size_t k = 0; k < entries.size();) {
+        const uint64_t key = entries[k].key;
+        double w = 0.0;
+        for (; k < entries.size() && entries[k].key == key; ++k) w += entries[k].w;
+        const int i = int(key >> 32), j = int(key & 0xFFFFFFFFu);
+        topo.adj_col.push_back(j);
+        topo.adj_len.push_back(glm::length(dvec3(topo.wpos[i]) - dvec3(topo.wpos[j])));
+        topo.adj_cot.push_back(w);
+        ++topo.adj_ptr[i + 1];
+    }
+    for (int i = 0; i < W; ++i) topo.adj_ptr[i + 1] += topo.adj_ptr[i];
+    return topo;
+}
+
+}  // namespace auto_rig
+}  // namespace plugins
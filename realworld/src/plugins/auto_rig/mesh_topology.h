@@ -0,0 +1,62 @@
+#pragma once
+// ============================================================================
+//  mesh_topology.h
+//
+//  Surface topology of a TriangleMesh, built once per loaded mesh and shared
+//  by every skin-weight path (the plugin's geodesic bake and the
+//  computeSkinWeightsAlgo solvers):
+//
+//    * weld        — original vertex -> welded id.  Two vertices merge only
+//                    when they are the endpoints of a COINCIDENT triangle edge
+//                    (see buildMeshTopology), so UV / normal seams close while
+//                    parts that merely touch stay separate.
+//    * components  — connected islands of the welded surface (layer split).
+//    * adjacency   — CSR over welded vertices with edge lengths, summed
+//                    half-cotangent weights and lumped vertex areas, i.e.
+//                    everything needed for Dijkstra and the cotan Laplacian.
+//
+//  Depends only on positions + indices; owners rebuild it when the geometry
+//  changes and reuse it across every re-bake otherwise.
+// ============================================================================
+
+#include "plugins/auto_rig/rig_types.h"
+
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace plugins {
+namespace auto_rig {
+
+struct MeshTopology {
+    int nv = 0;                            // original vertices
+    int num_welded = 0;                    // welded vertices (W)
+
+    std::vector<int>        wid;           // nv: original vertex -> welded id
+    std::vector<glm::vec3>  wpos;          // W: position (first original vertex)
+    std::vector<glm::ivec3> tris;          // welded triangles, input order
+
+    // Connected components.  comp[w] is the island's representative welded
+    // vertex; comp_index[w] the same island as a dense label, numbered by
+    // its lowest welded vertex.
+    std::vector<int> comp;
+    std::vector<int> comp_index;
+    int num_components = 0;
+
+    // Undirected edge graph, both directions stored, columns sorted per row.
+    std::vector<int>    adj_ptr;           // W + 1 offsets into adj_*
+    std::vector<int>    adj_col;
+    std::vector<double> adj_len;           // Euclidean edge length
+    std::vector<double> adj_cot;           // sum of half cotangents (unclamped)
+    std::vector<double> mass;              // W: lumped (barycentric) area
+
+    bool empty() const { return wpos.empty(); }
+    int  begin(int w) const { return adj_ptr[w]; }
+    int  end(int w)   const { return adj_ptr[w + 1]; }
+};
+
+// Weld, label components and assemble the edge graph of `mesh`.  Triangles
+// with out-of-range indices are ignored.
+MeshTopology buildMeshTopology(const TriangleMesh& mesh);
+
+}  // namespace auto_rig
+}  // namespace plugins
@@ -0,0 +1,147 @@
+// ============================================================================
+//  packed_skin_weights.cpp  —  see header for the high-level description.
+// ============================================================================
+
+#include "plugins/auto_rig/packed_skin_weights.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace plugins {
+namespace auto_rig {
+
+void PackedSkinWeights::reset(int num_joints, bool keep_closeness,
+                              size_t reserve_vertices) {
+    offset.assign(1, 0u);
+    joint8.clear(); joint16.clear(); weight.clear(); closeness.clear();
+    wide_joints   = num_joints > 256;
+    has_closeness = keep_closeness;
+    // ~3 live influences per vertex on typical rigs.
+    offset.reserve(reserve_vertices + 1);
+    const size_t guess = reserve_vertices * 3;
+    if (wide_joints) joint16.reserve(guess); else joint8.reserve(guess);
+    weight.reserve(guess);
+    if (has_closeness) closeness.reserve(guess);
+}
+
+void PackedSkinWeights::appendVertex(const int* joints, const float* weights,
+                                     const float* closeness_in, int n) {
+    constexpr int K = kMaxVertexInfluences;
+    n = std::min(n, K);
+    int    slot[K];
+    double share[K];
+    int    live = 0;
+    double total = 0.0;
+    for (int i = 0; i < n; ++i) {
+        if (joints[i] < 0 || !(weights[i] > 0.0f)) continue;
+        slot[live] = i; share[live] = weights[i]; total += weights[i]; ++live;
+    }
+
+    // Largest-remainder rounding: floor every share, then hand the missing
+    // units to the largest fractional parts (ties to the earlier slot), so
+    // the unorm16 weights sum to exactly kUnorm16One.
+    uint32_t q[K];
+    if (live > 0) {
+        double frac[K];
+        uint32_t sum = 0;
+        for (int i = 0; i < live; ++i) {
+            const double s = share[i] / total * kUnorm16One;
+            q[i] = std::min<uint32_t>(static_cast<uint32_t>(s), kUnorm16One);
+            frac[i] = s - q[i];
+            sum += q[i];
+        }
+        for (uint32_t r = sum; r < kUnorm16One; ++r) {
+            int best = 0;
+            for (int i = 1; i < live; ++i)
+                if (frac[i] > frac[best]) best = i;
+            ++q[best]; frac[best] = -1.0;
+        }
+    }
+
+    for (int i = 0; i < live; ++i) {
+        if (q[i] == 0) continue;               // below one unorm16 step
+        const int s = slot[i];
+        if (wide_joints) joint16.push_back(static_cast<uint16_t>(joints[s]));
+        else             joint8.push_back(static_cast<uint8_t>(joints[s]));
+        weight.push_back(static_cast<uint16_t>(q[i]));
+        if (has_closeness) {
+            const float c = closeness_in ? std::clamp(closeness_in[s], 0.0f, 1.0f) : 0.0f;
+            closeness.push_back(static_cast<uint16_t>(std::lround(c * kUnorm16One)));
+        }
+    }
+    offset.push_back(static_cast<uint32_t>(weight.size()));
+}
+
+VertexSkinData PackedSkinWeights::unpack(size_t v) const {
+    VertexSkinData vsd;
+    int i = 0;
+    for (uint32_t k = begin(v); k < end(v); ++k, ++i) {
+        vsd.joint_indices[i] = joint(k);
+        vsd.weights[i]       = weightOf(k);
+        vsd.closeness[i]     = closenessOf(k);
+    }
+    return vsd;
+}
+
+size_t PackedSkinWeights::bytes() const {
+    return offset.capacity() * sizeof(uint32_t) + joint8.capacity() +
+           joint16.capacity() * sizeof(uint16_t) +
+           weight.capacity() * sizeof(uint16_t) +
+           closeness.capacity() * sizeof(uint16_t);
+}
+
+std::vector<uint8_t> PackedSkinWeights::gltfJoints(int set, size_t num_vertices) const {
+    const size_t jb = static_cast<size_t>(gltfJointBytes());
+    std::vector<uint8_t> out(num_vertices * 4 * jb, 0);
+    const size_t nv = std::min(num_vertices, numVertices());
+    for (size_t v = 0; v < nv; ++v) {
+        const uint32_t b = begin(v) + 4 * set, e = end(v);
+        for (uint32_t k = b; k < e && k < b + 4; ++k) {
+            uint8_t* dst = out.data() + (v * 4 + (k - b)) * jb;
+            if (wide_joints) std::memcpy(dst, &joint16[k], sizeof(uint16_t));
+            else             *dst = joint8[k];
+        }
+    }
+    return out;
+}
+
+std::vector<uint16_t> PackedSkinWeights::gltfWeights(int set, size_t num_vertices) const {
+    std::vector<uint16_t> out(num_vertices * 4, 0);
+    const size_t nv = std::min(num_vertices, numVertices());
+    for (size_t v = 0; v < nv; ++v) {
+        const uint32_t b = begin(v) + 4 * set, e = end(v);
+        for (uint32_t k = b; k < e && k < b + 4; ++k) out[v * 4 + (k - b)] = weight[k];
+    }
+    return out;
+}
+
+std::vector<float> PackedSkinWeights::gltfCloseness(int set, size_t num_vertices) const {
+    std::vector<float> out(num_vertices * 4, 0.0f);
+    const size_t nv = std::min(num_vertices, numVertices());
+    for (size_t v = 0; v < nv; ++v) {
+        const uint32_t b = begin(v) + 4 * set, e = end(v);
+        for (uint32_t k = b; k < e && k < b + 4; ++k) out[v * 4 + (k - b)] = closenessOf(k);
+    }
+    return out;
+}
+
+PackedSkinWeights packSkinWeights(const SkinWeights& weights, int num_joints,
+                                  bool keep_closeness) {
+    PackedSkinWeights packed;
+    packed.reset(num_joints, keep_closeness, weights.per_vertex.size());
+    for (const auto& vsd : weights.per_vertex)
+        packed.appendVertex(vsd.joint_indices, vsd.weights, vsd.closeness,
+                            kMaxVertexInfluences);
+    return packed;
+}
+
+SkinWeights unpackSkinWeights(const PackedSkinWeights& packed) {
+    SkinWeights out;
+    out.per_vertex.resize(packed.numVertices());
+    for (size_t v = 0; v < out.per_vertex.size(); ++v) out.per_vertex[v] = packed.unpack(v);
+    return out;
+}
+
+}  // namespace auto_rig
+}  // namespace plugins
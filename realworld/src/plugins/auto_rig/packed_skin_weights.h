@@ -0,0 +1,85 @@
+#pragma once
+// ============================================================================
+//  packed_skin_weights.h
+//
+//  Compact storage for baked skin weights.  VertexSkinData spends 96 bytes on
+//  every vertex (8 x int joint, float weight, float closeness) although most
+//  vertices carry 1-3 influences.  PackedSkinWeights keeps only the live
+//  influences, structure-of-arrays, behind a per-vertex offset table:
+//
+//    * joints     — uint8 when the skeleton has <= 256 joints, else uint16.
+//    * weights    — unorm16.  Each vertex is quantized with largest-remainder
+//                   rounding so its weights sum to EXACTLY 65535, i.e. exactly
+//                   1.0 after decoding; no float renormalization drift.
+//    * closeness  — optional unorm16 channel parallel to the weights.
+//
+//  Influences keep their slot order (strongest first, as baked), so slot k
+//  of the packed vertex is slot k of the VertexSkinData it came from.  The
+//  glTF helpers emit JOINTS_n / WEIGHTS_n straight from the stored bits
+//  (UNSIGNED_BYTE or UNSIGNED_SHORT joints, normalized UNSIGNED_SHORT
+//  weights), so export is lossless with respect to this representation.
+// ============================================================================
+
+#include "plugins/auto_rig/rig_types.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace plugins {
+namespace auto_rig {
+
+struct PackedSkinWeights {
+    static constexpr uint32_t kUnorm16One = 65535;
+
+    // Influences of vertex v are entries [offset[v], offset[v + 1]).
+    std::vector<uint32_t> offset;
+    std::vector<uint8_t>  joint8;          // used when !wide_joints
+    std::vector<uint16_t> joint16;         // used when  wide_joints
+    std::vector<uint16_t> weight;          // unorm16, per-vertex sum == kUnorm16One
+    std::vector<uint16_t> closeness;       // unorm16, empty unless has_closeness
+    bool wide_joints   = false;
+    bool has_closeness = false;
+
+    size_t numVertices() const { return offset.empty() ? 0 : offset.size() - 1; }
+    bool   empty() const { return numVertices() == 0; }
+    uint32_t begin(size_t v) const { return offset[v]; }
+    uint32_t end(size_t v)   const { return offset[v + 1]; }
+    int    count(size_t v) const { return static_cast<int>(offset[v + 1] - offset[v]); }
+
+    int   joint(uint32_t k) const { return wide_joints ? joint16[k] : joint8[k]; }
+    float weightOf(uint32_t k) const { return weight[k] * (1.0f / kUnorm16One); }
+    float closenessOf(uint32_t k) const {
+        return has_closeness ? closeness[k] * (1.0f / kUnorm16One) : 0.0f;
+    }
+
+    // Start an empty table for a skeleton of `num_joints` joints.
+    void reset(int num_joints, bool keep_closeness, size_t reserve_vertices = 0);
+
+    // Append the next vertex from up to kMaxVertexInfluences slots.  Slots
+    // with a negative joint or a non-positive weight are skipped; the rest
+    // are renormalized to sum to one.  `closeness_in` may be null.
+    void appendVertex(const int* joints, const float* weights,
+                      const float* closeness_in, int n);
+
+    // Expand vertex v back to the fixed 8-slot layout (unused slots zero).
+    VertexSkinData unpack(size_t v) const;
+
+    // Heap bytes held by the table.
+    size_t bytes() const;
+
+    // One glTF skin set (slots 4*set .. 4*set+3) as VEC4 per vertex for
+    // `num_vertices` vertices, zero-padded past numVertices().  Joint data
+    // is raw little-endian components of gltfJointBytes() bytes each.
+    int gltfJointBytes() const { return wide_joints ? 2 : 1; }
+    std::vector<uint8_t>  gltfJoints(int set, size_t num_vertices) const;
+    std::vector<uint16_t> gltfWeights(int set, size_t num_vertices) const;
+    std::vector<float>    gltfCloseness(int set, size_t num_vertices) const;
+};
+
+PackedSkinWeights packSkinWeights(const SkinWeights& weights, int num_joints,
+                                  bool keep_closeness = true);
+SkinWeights unpackSkinWeights(const PackedSkinWeights& packed);
+
+}  // namespace auto_rig
+}  // namespace plugins
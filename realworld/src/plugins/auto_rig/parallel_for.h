@@ -0,0 +1,161 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace plugins {
+namespace auto_rig {
+
+// ---------------------------------------------------------------------------
+//  parallelFor – minimal fork/join helper for the auto-rig CPU passes.
+//
+//  Runs fn(i) for every i in [0, count) on up to workerCount() threads (the
+//  calling thread participates).  Items are handed out one at a time from a
+//  shared counter, so uneven work items (screen tiles, joints, views) balance
+//  on their own.  A parallelFor issued from inside a running parallelFor
+//  executes serially on the calling worker, so nested use (orbit views ->
+//  screen tiles) never oversubscribes the machine.
+//
+//  The workers are a persistent pool (workerCount() - 1 threads, started on
+//  first use and joined at exit), so a call costs a queue push and a wake-up
+//  rather than a thread spawn per worker.  Calls from several threads at once
+//  share the pool; each caller always works on its own items, so it never
+//  waits on another caller's job.  If fn throws, the remaining items of that
+//  call are skipped and the first exception is rethrown to the caller once
+//  every worker has left the job.
+//
+//  fn must only write to state owned by its item; results that need a
+//  deterministic order are written to per-item slots and merged afterwards.
+// ---------------------------------------------------------------------------
+inline int workerCount() {
+    static const int n =
+        std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    return n;
+}
+
+namespace detail {
+inline bool& inParallelRegion() {
+    static thread_local bool inside = false;
+    return inside;
+}
+
+// One parallelFor call: a type-erased fn plus the shared item counter.
+struct ParallelJob {
+    const void* fn = nullptr;
+    void (*invoke)(const void* fn, int i) = nullptr;
+    int count = 0;
+    std::atomic<int>  next{0};
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;                  // first exception (under error_mutex)
+    std::mutex         error_mutex;
+    int users = 0;                             // pool workers inside (under pool mutex)
+
+    // Claim and run items until none are left.
+    void work() {
+        for (int i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+            if (failed.load(std::memory_order_relaxed)) continue;
+            try {
+                invoke(fn, i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!error) error = std::current_exception();
+                failed.store(true, std::memory_order_relaxed);
+            }
+        }
+    }
+};
+
+class WorkerPool {
+public:
+    static WorkerPool& instance() {
+        static WorkerPool pool;
+        return pool;
+    }
+
+    void run(ParallelJob& job) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            jobs_.push_back(&job);
+        }
+        wake_.notify_all();
+
+        inParallelRegion() = true;
+        job.work();
+        inParallelRegion() = false;
+
+        // Every item is claimed; wait for the workers still running one.
+        std::unique_lock<std::mutex> lock(mutex_);
+        retire(job);
+        done_.wait(lock, [&] { return job.users == 0; });
+        lock.unlock();
+        if (job.error) std::rethrow_exception(job.error);
+    }
+
+private:
+    WorkerPool() {
+        const int n = workerCount() - 1;
+        threads_.reserve(n);
+        for (int t = 0; t < n; ++t) threads_.emplace_back([this] { workerLoop(); });
+    }
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (auto& th : threads_) th.join();
+    }
+
+    void retire(ParallelJob& job) {            // caller holds mutex_
+        auto it = std::find(jobs_.begin(), jobs_.end(), &job);
+        if (it != jobs_.end()) jobs_.erase(it);
+    }
+
+    void workerLoop() {
+        inParallelRegion() = true;
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            wake_.wait(lock, [&] { return stop_ || !jobs_.empty(); });
+            if (stop_) return;
+            ParallelJob& job = *jobs_.front();
+            ++job.users;
+            lock.unlock();
+            job.work();
+            lock.lock();
+            retire(job);                       // exhausted: nobody else should join it
+            if (--job.users == 0) done_.notify_all();
+        }
+    }
+
+    std::mutex                 mutex_;
+    std::condition_variable    wake_;          // jobs_ gained an entry, or stop_
+    std::condition_variable    done_;          // a job lost its last worker
+    std::deque<ParallelJob*>   jobs_;
+    std::vector<std::thread>   threads_;
+    bool                       stop_ = false;
+};
+}  // namespace detail
+
+template <class Fn>
+void parallelFor(int count, Fn&& fn) {
+    if (count <= 0) return;
+    if (count == 1 || workerCount() <= 1 || detail::inParallelRegion()) {
+        for (int i = 0; i < count; ++i) fn(i);
+        return;
+    }
+    using F = std::remove_reference_t<Fn>;
+    detail::ParallelJob job;
+    job.fn     = &fn;
+    job.invoke = [](const void* f, int i) { (*static_cast<F*>(const_cast<void*>(f)))(i); };
+    job.count  = count;
+    detail::WorkerPool::instance().run(job);
+}
+
+}  // namespace auto_rig
+}  // namespace plugins
@@ -0,0 +1,320 @@
+// ---------------------------------------------------------------------------
+//  autorig_raster_bench – headless benchmark for the auto-rig CPU rasterizer.
+//
+//  Loads meshes through loadMeshForThumbnail (glTF / GLB / FBX) with their
+//  UVs and base-colour texture, then times SimpleRasterizer::render,
+//  ::renderOIT and ::captureOrbit over a fixed grid of resolutions and view
+//  counts.  Cameras, repetitions and mesh order are fixed, so two builds run
+//  on the same machine produce comparable numbers.  Results are printed to
+//  stdout as JSON (progress goes to stderr):
+//
+//    { "meshes": [ { "path", "triangles", "vertices", "texture",
+//        "texture_size", "cases": [
+//        { "op", "shading", "resolution", "views", "ms_median", "ms_min",
+//          "ms_per_view", "triangles_per_sec", "alloc_bytes_per_rep",
+//          "checksum" } ] } ],
+//      "threads", "peak_rss_mb" }
+//
+//  render and renderOIT run with sample_texture, as the interactive previews
+//  do, so they cover per-pixel texturing and mip selection; captureOrbit
+//  shades from vertex colours like the model captures.  Meshes without a
+//  glTF base-colour texture (FBX, untextured glTF) get a synthetic one over
+//  planar UVs; "texture" says which ("gltf" / "synthetic").  peak_rss_mb is
+//  the process high-water mark at exit.  alloc_bytes_per_rep is the capture
+//  and scratch storage the rasterizer had to allocate per timed repetition
+//  (CapturePoolStats); steady-state re-renders should report 0.
+//
+//  Only the rasterizer call is timed.  `checksum` is an FNV-1a hash of the
+//  colour / depth output of the last repetition, taken after the clock stops;
+//  an optimisation that is meant to be bit-exact must keep it.  Every case
+//  runs with forward and with deferred shading (the plugin's default), unless
+//  --forward or --deferred picks one.
+//
+//  Usage (run from realworld/ so the default asset paths resolve):
+//    autorig_raster_bench [--res 256,512,1024] [--views 4,8,16]
+//                         [--orbit-res 256,512] [--reps 5]
+//                         [--forward | --deferred] [mesh ...]
+//  With no mesh arguments every glTF sample plus any .fbx under assets/ is
+//  used.  No window or GPU is created.
+// ---------------------------------------------------------------------------
+
+#define TINYGLTF_IMPLEMENTATION
+#define STB_IMAGE_IMPLEMENTATION
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "tiny_gltf.h"
+
+#include "simple_rasterizer.h"
+#include "parallel_for.h"
+#include "json.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <glm/gtc/matrix_transform.hpp>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+using namespace plugins::auto_rig;
+using nlohmann::json;
+
+namespace {
+
+// Process peak resident set size in MiB (0 where unsupported).
+double peakRssMb() {
+#if defined(__linux__)
+    rusage ru{};
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_maxrss / 1024.0;              // KiB on Linux
+#elif defined(__APPLE__)
+    rusage ru{};
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_maxrss / (1024.0 * 1024.0);   // bytes on macOS
+#else
+    return 0.0;
+#endif
+}
+
+uint64_t fnv1a(uint64_t h, const void* data, size_t bytes) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < bytes; ++i) {
+        h ^= p[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+uint64_t captureChecksum(uint64_t h, const ViewCapture& cap) {
+    h = fnv1a(h, cap.color.data(), cap.color.size());
+    h = fnv1a(h, cap.color_rgba.data(), cap.color_rgba.size());
+    h = fnv1a(h, cap.depth.data(), cap.depth.size() * sizeof(float));
+    return h;
+}
+
+std::vector<int> parseList(const char* s) {
+    std::vector<int> out;
+    for (const char* p = s; *p;) {
+        char* end = nullptr;
+        long v = std::strtol(p, &end, 10);
+        if (end == p) break;
+        if (v > 0) out.push_back(static_cast<int>(v));
+        p = (*end == ',') ? end + 1 : end;
+    }
+    return out;
+}
+
+// Deterministic 512x512 RGB pattern (checker plus gradients) mapped with
+// planar UVs over the mesh's X/Y bounds, tiled 4x so minification picks
+// real mip levels.  Stands in for meshes that ship without a base-colour
+// texture.
+void attachSyntheticTexture(TriangleMesh& mesh) {
+    SimpleTexture& tex = mesh.base_color_texture;
+    tex.width = tex.height = 512;
+    tex.channels = 3;
+    tex.pixels.resize(size_t(512) * 512 * 3);
+    for (int y = 0; y < 512; ++y) {
+        for (int x = 0; x < 512; ++x) {
+            const bool check = ((x >> 5) ^ (y >> 5)) & 1;
+            uint8_t* px = &tex.pixels[(size_t(y) * 512 + x) * 3];
+            px[0] = static_cast<uint8_t>(check ? 220 : x / 2);
+            px[1] = static_cast<uint8_t>(check ? 200 : y / 2);
+            px[2] = static_cast<uint8_t>(check ? 40 : (x ^ y) & 255);
+        }
+    }
+    tex.buildMips();
+
+    const glm::vec3 ext = glm::max(mesh.bbox_max - mesh.bbox_min, glm::vec3(1e-6f));
+    mesh.texcoords.resize(mesh.positions.size());
+    for (size_t i = 0; i < mesh.positions.size(); ++i) {
+        const glm::vec3 p = (mesh.positions[i] - mesh.bbox_min) / ext;
+        mesh.texcoords[i] = glm::vec2(p.x, p.y) * 4.0f;
+    }
+    mesh.texture_tints.assign(mesh.positions.size(), glm::vec3(1.0f));
+}
+
+// Fixed three-quarter camera framing the mesh bounds (same framing rules as
+// captureOrbit, so single-view and orbit numbers are comparable).
+void benchCamera(const TriangleMesh& mesh, glm::mat4& view, glm::mat4& proj) {
+    glm::vec3 centre = (mesh.bbox_min + mesh.bbox_max) * 0.5f;
+    float radius = glm::length(mesh.bbox_max - mesh.bbox_min) * 1.2f;
+    float az = glm::radians(30.0f), el = glm::radians(15.0f);
+    glm::vec3 eye = centre + radius * glm::vec3(cosf(el) * cosf(az), sinf(el),
+                                                cosf(el) * sinf(az));
+    view = glm::lookAt(eye, centre, glm::vec3(0, 1, 0));
+    proj = glm::perspective(glm::radians(45.0f), 1.0f, radius * 0.01f, radius * 4.0f);
+    proj[1][1] *= -1.0f;
+}
+
+// Runs `fn` (returning the captures it rendered) once to warm up, then
+// `reps` timed times.  Checksumming and handing the output back to the
+// capture pool (as the plugin does between re-renders) stay outside the
+// timed region.
+template <class Fn>
+json timeCase(SimpleRasterizer& rasterizer, const char* op, const char* shading,
+              int resolution, int views, size_t tris, int reps, Fn&& fn) {
+    std::vector<ViewCapture> out = fn();
+    const SimpleRasterizer::CapturePoolStats before = rasterizer.capturePoolStats();
+    std::vector<double> ms;
+    for (int r = 0; r < reps; ++r) {
+        rasterizer.recycle(std::move(out));
+        auto t0 = std::chrono::steady_clock::now();
+        std::vector<ViewCapture> caps = fn();
+        auto t1 = std::chrono::steady_clock::now();
+        ms.push_back(std::chrono::duration<double, std::milli>(t1 - t0).count());
+        out = std::move(caps);
+    }
+    const SimpleRasterizer::CapturePoolStats after = rasterizer.capturePoolStats();
+    const uint64_t allocated =
+        (after.bytes_allocated - before.bytes_allocated) +
+        (after.scratch_bytes_allocated - before.scratch_bytes_allocated);
+    std::sort(ms.begin(), ms.end());
+    const double median = ms[ms.size() / 2];
+
+    uint64_t checksum = 1469598103934665603ull;
+    for (const ViewCapture& cap : out) checksum = captureChecksum(checksum, cap);
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(checksum));
+    std::fprintf(stderr, "[Bench]   %-12s %-8s res=%-5d views=%-3d %9.2f ms\n",
+                 op, shading, resolution, views, median);
+    return {
+        { "op",                op },
+        { "shading",           shading },
+        { "resolution",        resolution },
+        { "views",             views },
+        { "ms_median",         median },
+        { "ms_min",            ms.front() },
+        { "ms_per_view",       median / views },
+        { "triangles_per_sec", median > 0.0 ? tris * views / (median * 1e-3) : 0.0 },
+        { "alloc_bytes_per_rep", allocated / reps },
+        { "checksum",          hex },
+    };
+}
+
+std::vector<std::string> defaultMeshes() {
+    std::vector<std::string> paths = {
+        "assets/Duck.glb",
+        "assets/CesiumMan.gltf",
+        "assets/BrainStem.glb",
+        "assets/DamagedHelmet.glb",
+        "assets/Characters/scene.gltf",
+    };
+    std::vector<std::string> fbx;
+    std::error_code ec;
+    if (std::filesystem::is_directory("assets", ec)) {
+        for (auto it = std::filesystem::recursive_directory_iterator("assets", ec);
+             it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+            if (ec) break;
+            std::string ext = it->path().extension().string();
+            std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+            if (ext == ".fbx") fbx.push_back(it->path().generic_string());
+        }
+    }
+    std::sort(fbx.begin(), fbx.end());   // directory order is not stable
+    paths.insert(paths.end(), fbx.begin(), fbx.end());
+    return paths;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::vector<int> resolutions = { 256, 512, 1024 };
+    std::vector<int> orbit_res   = { 256, 512 };
+    std::vector<int> view_counts = { 4, 8, 16 };
+    int reps = 5;
+    std::vector<bool> shading_modes = { false, true };   // deferred off / on
+    std::vector<std::string> paths;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if      (a == "--res"       && i + 1 < argc) resolutions = parseList(argv[++i]);
+        else if (a == "--orbit-res" && i + 1 < argc) orbit_res   = parseList(argv[++i]);
+        else if (a == "--views"     && i + 1 < argc) view_counts = parseList(argv[++i]);
+        else if (a == "--reps"      && i + 1 < argc) reps = std::max(1, std::atoi(argv[++i]));
+        else if (a == "--forward")  shading_modes = { false };
+        else if (a == "--deferred") shading_modes = { true };
+        else if (a == "--help" || a == "-h") {
+            std::fprintf(stderr,
+                "usage: %s [--res a,b,..] [--orbit-res a,b,..] [--views a,b,..] "
+                "[--reps n] [--forward | --deferred] [mesh ...]\n", argv[0]);
+            return 0;
+        }
+        else paths.push_back(a);
+    }
+    if (paths.empty()) paths = defaultMeshes();
+
+    SimpleRasterizer rasterizer;
+    json meshes = json::array();
+
+    for (const std::string& path : paths) {
+        TriangleMesh mesh;
+        if (!std::filesystem::exists(path) || !loadMeshForThumbnail(path, mesh, /*with_texture=*/true)) {
+            std::fprintf(stderr, "[Bench] skipping %s (not found / no triangles)\n",
+                         path.c_str());
+            continue;
+        }
+        const bool own_texture = !mesh.base_color_texture.empty();
+        if (!own_texture) attachSyntheticTexture(mesh);
+        const size_t tris = mesh.indices.size() / 3;
+        std::fprintf(stderr, "[Bench] %s: %zu triangles, %zu vertices, %s texture %dx%d\n",
+                     path.c_str(), tris, mesh.positions.size(),
+                     own_texture ? "glTF" : "synthetic",
+                     mesh.base_color_texture.width, mesh.base_color_texture.height);
+
+        glm::mat4 view, proj;
+        benchCamera(mesh, view, proj);
+
+        json cases = json::array();
+        for (bool deferred : shading_modes) {
+            rasterizer.setDeferredShading(deferred);
+            const char* shading = deferred ? "deferred" : "forward";
+            for (int res : resolutions) {
+                cases.push_back(timeCase(rasterizer, "render", shading, res, 1, tris,
+                                         reps, [&] {
+                    std::vector<ViewCapture> caps;
+                    caps.push_back(rasterizer.render(mesh, res, res, view, proj,
+                                                     0.0f, 0.0f, /*sample_texture=*/true));
+                    return caps;
+                }));
+                cases.push_back(timeCase(rasterizer, "renderOIT", shading, res, 1, tris,
+                                         reps, [&] {
+                    std::vector<ViewCapture> caps;
+                    caps.push_back(rasterizer.renderOIT(mesh, res, res, view, proj, 0.6f,
+                                                        0.0f, 0.0f, /*sample_texture=*/true));
+                    return caps;
+                }));
+            }
+            for (int res : orbit_res) {
+                for (int views : view_counts) {
+                    cases.push_back(timeCase(rasterizer, "captureOrbit", shading, res,
+                                             views, tris, reps, [&] {
+                        return rasterizer.captureOrbit(mesh, views, res);
+                    }));
+                }
+            }
+        }
+
+        meshes.push_back({
+            { "path",      path },
+            { "triangles", tris },
+            { "vertices",  mesh.positions.size() },
+            { "texture",   own_texture ? "gltf" : "synthetic" },
+            { "texture_size", { mesh.base_color_texture.width,
+                                mesh.base_color_texture.height } },
+            { "cases",     std::move(cases) },
+        });
+    }
+
+    json out = {
+        { "meshes",      std::move(meshes) },
+        { "threads",     workerCount() },
+        { "reps",        reps },
+        { "peak_rss_mb", peakRssMb() },
+    };
+    std::printf("%s\n", out.dump(2).c_str());
+    return 0;
+}
@@ -17,10 +17,37 @@ struct SimpleTexture {
     int channels = 0;                        // 3=RGB, 4=RGBA
     std::vector<uint8_t> pixels;             // row-major, top-to-bottom
 
+    // Mip chain built by buildMips(): every level is RGBA8 (alpha padded for
+    // RGB sources) stored in 4x4-texel tiles, so one 64-byte cache line holds
+    // a whole tile and a bilinear footprint touches at most four lines.
+    struct MipLevel {
+        int width   = 0;
+        int height  = 0;
+        int tiles_x = 0;                     // 4x4 tiles per tile row
+        std::vector<uint32_t> texels;        // tile-major, row-major in a tile
+
+        uint32_t at(int x, int y) const {
+            return texels[((y >> 2) * tiles_x + (x >> 2)) * 16 + (y & 3) * 4 + (x & 3)];
+        }
+    };
+    std::vector<MipLevel> mips;
+
     bool empty() const { return pixels.empty(); }
 
-    // Sample at UV (bilinear, wrapping).
+    // Build `mips` from `pixels` (2x2 box filter down to 1x1).  Call once
+    // after loading; textures without a chain sample `pixels` directly.
+    void buildMips();
+
+    // Sample at UV (bilinear, wrapping) from the full-resolution pixels.
     glm::vec3 sample(const glm::vec2& uv) const;
+
+    // Sample at UV (bilinear, wrapping) from the mip level nearest to `lod`
+    // (see mipLod).  Falls back to sample(uv) without a mip chain.
+    glm::vec3 sample(const glm::vec2& uv, float lod) const;
+
+    // Level of detail (log2 texel footprint) for a pixel whose UV changes by
+    // duv_dx / duv_dy per one-pixel step in screen x / y.
+    float mipLod(const glm::vec2& duv_dx, const glm::vec2& duv_dy) const;
 };
 
 struct TriangleMesh {
@@ -31,6 +58,8 @@ struct TriangleMesh {
     std::vector<uint32_t>  indices;          // triangle list
 
     SimpleTexture base_color_texture;        // base color / albedo map
+    std::vector<glm::vec3> texture_tints;    // per-vertex multiplier on base_color_texture
+                                             // (vertex_colors holds the baked product)
 
     glm::vec3 bbox_min{  1e30f };
     glm::vec3 bbox_max{ -1e30f };
@@ -129,6 +158,24 @@ struct SkinWeights {
     bool empty() const { return per_vertex.empty(); }
 };
 
+// Solver used by computeSkinWeightsAlgo (skinning_weights.h).
+enum class SkinWeightAlgo {
+    kNearestBone,                            // legacy inverse distance / fallback
+    kBoneHeat,
+    kGeodesic,
+    kBiharmonic,
+};
+
+inline const char* skinWeightAlgoName(SkinWeightAlgo algo) {
+    switch (algo) {
+        case SkinWeightAlgo::kNearestBone: return "nearest-bone";
+        case SkinWeightAlgo::kBoneHeat:    return "bone-heat";
+        case SkinWeightAlgo::kGeodesic:    return "geodesic";
+        case SkinWeightAlgo::kBiharmonic:  return "biharmonic";
+    }
+    return "unknown";
+}
+
 // ---------------------------------------------------------------------------
 //  Skeletal animation clip (keyframed LOCAL joint rotations).
 //
@@ -1,8 +1,11 @@
 #include "simple_rasterizer.h"
+#include "parallel_for.h"
 #include <algorithm>
 #include <cmath>
 #include <cstdio>
 #include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <functional>
 #include <limits>
 #include <unordered_map>
@@ -12,6 +15,25 @@
 #include "tiny_gltf.h"                 // glTF / GLB geometry (decls; impl elsewhere)
 #include "third_parties/fbx/ufbx.h"   // FBX geometry (decls; impl in ufbx.c)
 
+#if defined(__x86_64__) || defined(_M_X64)
+#define SR_HAS_X86_SIMD 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#else
+#define SR_HAS_X86_SIMD 0
+#endif
+
+// AVX2 kernels are compiled for that ISA only (GCC/Clang need the per-function
+// target; MSVC emits AVX intrinsics without /arch).  FMA is deliberately NOT
+// enabled so the blocked kernels round exactly like the scalar one.
+#if SR_HAS_X86_SIMD && (defined(__GNUC__) || defined(__clang__))
+#define SR_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define SR_TARGET_AVX2
+#endif
+
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
@@ -57,6 +79,130 @@ glm::vec3 SimpleTexture::sample(const glm::vec2& uv) const {
                     glm::mix(c01, c11, sx), sy);
 }
 
+// ── SimpleTexture mip chain ────────────────────────────────────────────────
+
+void SimpleTexture::buildMips() {
+    mips.clear();
+    if (empty() || width <= 0 || height <= 0 || channels < 3) return;
+
+    auto allocLevel = [](int w, int h) {
+        MipLevel m;
+        m.width   = w;
+        m.height  = h;
+        m.tiles_x = (w + 3) / 4;
+        m.texels.assign(static_cast<size_t>(m.tiles_x) * ((h + 3) / 4) * 16, 0u);
+        return m;
+    };
+    auto texelIndex = [](const MipLevel& m, int x, int y) {
+        return static_cast<size_t>(((y >> 2) * m.tiles_x + (x >> 2)) * 16 +
+                                   (y & 3) * 4 + (x & 3));
+    };
+    auto pack = [](uint32_t r, uint32_t g, uint32_t b, uint32_t a) {
+        return r | (g << 8) | (b << 16) | (a << 24);
+    };
+
+    // Level 0: re-pack into tiled RGBA8.
+    MipLevel base = allocLevel(width, height);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            const uint8_t* p = &pixels[(static_cast<size_t>(y) * width + x) * channels];
+            base.texels[texelIndex(base, x, y)] =
+                pack(p[0], p[1], p[2], channels >= 4 ? p[3] : 255u);
+        }
+    }
+    mips.push_back(std::move(base));
+
+    // Remaining levels: 2x2 box filter (edge texels clamp on odd sizes).
+    while (mips.back().width > 1 || mips.back().height > 1) {
+        const MipLevel& src = mips.back();
+        MipLevel dst = allocLevel(std::max(1, src.width / 2),
+                                  std::max(1, src.height / 2));
+        for (int y = 0; y < dst.height; ++y) {
+            const int sy0 = std::min(2 * y,     src.height - 1);
+            const int sy1 = std::min(2 * y + 1, src.height - 1);
+            for (int x = 0; x < dst.width; ++x) {
+                const int sx0 = std::min(2 * x,     src.width - 1);
+                const int sx1 = std::min(2 * x + 1, src.width - 1);
+                const uint32_t t[4] = { src.at(sx0, sy0), src.at(sx1, sy0),
+                                        src.at(sx0, sy1), src.at(sx1, sy1) };
+                uint32_t out = 0;
+                for (int c = 0; c < 4; ++c) {
+                    uint32_t sum = 2;   // round to nearest
+                    for (uint32_t v : t) sum += (v >> (8 * c)) & 0xFFu;
+                    out |= (sum >> 2) << (8 * c);
+                }
+                dst.texels[texelIndex(dst, x, y)] = out;
+            }
+        }
+        mips.push_back(std::move(dst));
+    }
+}
+
+float SimpleTexture::mipLod(const glm::vec2& duv_dx, const glm::vec2& duv_dy) const {
+    if (mips.empty()) return 0.0f;
+    const glm::vec2 size(static_cast<float>(width), static_cast<float>(height));
+    const glm::vec2 tx = duv_dx * size;
+    const glm::vec2 ty = duv_dy * size;
+    const float rho2 = std::max(glm::dot(tx, tx), glm::dot(ty, ty));
+    if (!(rho2 > 1.0f)) return 0.0f;   // magnified (or degenerate): full res
+    return 0.5f * std::log2(rho2);
+}
+
+glm::vec3 SimpleTexture::sample(const glm::vec2& uv, float lod) const {
+    if (mips.empty()) return sample(uv);
+
+    // Nearest level; NaN / negative LOD selects the full-resolution level.
+    int level = 0;
+    if (lod > 0.5f)
+        level = std::min(static_cast<int>(lod + 0.5f),
+                         static_cast<int>(mips.size()) - 1);
+    const MipLevel& m = mips[level];
+
+    // Same wrap + bilinear footprint as sample(uv), on this level.
+    float u = uv.x - std::floor(uv.x);
+    float v = uv.y - std::floor(uv.y);
+    float fx = u * (m.width  - 1);
+    float fy = v * (m.height - 1);
+
+    int x0 = std::clamp((int)std::floor(fx), 0, m.width  - 1);
+    int y0 = std::clamp((int)std::floor(fy), 0, m.height - 1);
+    int x1 = std::min(x0 + 1, m.width  - 1);
+    int y1 = std::min(y0 + 1, m.height - 1);
+
+    float sx = fx - x0;
+    float sy = fy - y0;
+
+#if SR_HAS_X86_SIMD
+    // Widen each RGBA8 texel to 4 floats and blend all channels at once.
+    const __m128i zero = _mm_setzero_si128();
+    auto load = [&](int x, int y) {
+        __m128i t = _mm_cvtsi32_si128(static_cast<int>(m.at(x, y)));
+        t = _mm_unpacklo_epi16(_mm_unpacklo_epi8(t, zero), zero);
+        return _mm_cvtepi32_ps(t);
+    };
+    const __m128 wx1 = _mm_set1_ps(sx), wx0 = _mm_set1_ps(1.0f - sx);
+    const __m128 wy1 = _mm_set1_ps(sy), wy0 = _mm_set1_ps(1.0f - sy);
+    const __m128 top = _mm_add_ps(_mm_mul_ps(load(x0, y0), wx0),
+                                  _mm_mul_ps(load(x1, y0), wx1));
+    const __m128 bot = _mm_add_ps(_mm_mul_ps(load(x0, y1), wx0),
+                                  _mm_mul_ps(load(x1, y1), wx1));
+    const __m128 c = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(top, wy0), _mm_mul_ps(bot, wy1)),
+                                _mm_set1_ps(1.0f / 255.0f));
+    alignas(16) float out[4];
+    _mm_store_ps(out, c);
+    return glm::vec3(out[0], out[1], out[2]);
+#else
+    auto fetch = [&](int x, int y) -> glm::vec3 {
+        const uint32_t t = m.at(x, y);
+        return glm::vec3(float(t & 0xFFu), float((t >> 8) & 0xFFu),
+                         float((t >> 16) & 0xFFu));
+    };
+    glm::vec3 c = glm::mix(glm::mix(fetch(x0, y0), fetch(x1, y0), sx),
+                           glm::mix(fetch(x0, y1), fetch(x1, y1), sx), sy);
+    return c * (1.0f / 255.0f);
+#endif
+}
+
 // ── Helpers ─────────────────────────────────────────────────────────────────
 
 static glm::vec3 perspectiveDivide(const glm::vec4& clip) {
@@ -75,17 +221,322 @@ static float edgeFunction(const glm::vec2& a, const glm::vec2& b, const glm::vec
     return (p.x - a.x) * (b.y - a.y) - (p.y - a.y) * (b.x - a.x);
 }
 
+// ── SIMD edge-function kernels ──────────────────────────────────────────────
+//
+//  Each kernel walks the clipped bounding box row by row in blocks of 1, 4
+//  (SSE) or 8 (AVX2) pixels and evaluates, per lane:
+//    coverage          – the two edge functions (third = 1 - w0 - w1)
+//    depth             – w0*z0 + w1*z1 + w2*z2
+//    interpolated attr – w0*a0 + w1*a1 + w2*a2   (the shading normal)
+//  The per-row edge terms are hoisted and the pixel x coordinates step by the
+//  block width (exact in float), so every lane performs the SAME operations
+//  in the same order as the scalar loop — the blocked kernels are
+//  bit-identical to it, they just do 4 / 8 pixels per instruction.  Covered
+//  lanes are handed to the fragment sink in ascending x.
+// ─────────────────────────────────────────────────────────────────────────────
+
+namespace {
+
+enum class SimdLevel { kScalar, kSse, kAvx2 };
+
+SimdLevel detectSimdLevel() {
+    SimdLevel level = SimdLevel::kScalar;
+#if SR_HAS_X86_SIMD
+    level = SimdLevel::kSse;                      // SSE2 is baseline on x86-64
+#if defined(_MSC_VER)
+    int r[4];
+    __cpuid(r, 0);
+    if (r[0] >= 7) {
+        __cpuid(r, 1);
+        const bool osxsave = (r[2] & (1 << 27)) != 0;
+        const bool avx     = (r[2] & (1 << 28)) != 0;
+        __cpuidex(r, 7, 0);
+        const bool avx2    = (r[1] & (1 << 5)) != 0;
+        if (osxsave && avx && avx2 && (_xgetbv(0) & 0x6) == 0x6)
+            level = SimdLevel::kAvx2;
+    }
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) level = SimdLevel::kAvx2;
+#endif
+#endif
+    // AUTORIG_RASTER_SIMD=scalar|sse|avx2 caps the level (A/B timing).
+    if (const char* env = std::getenv("AUTORIG_RASTER_SIMD")) {
+        SimdLevel cap = level;
+        if      (std::strcmp(env, "scalar") == 0) cap = SimdLevel::kScalar;
+        else if (std::strcmp(env, "sse")    == 0) cap = SimdLevel::kSse;
+        if (static_cast<int>(cap) < static_cast<int>(level)) level = cap;
+    }
+    return level;
+}
+
+SimdLevel activeSimdLevel() {
+    static const SimdLevel level = detectSimdLevel();
+    return level;
+}
+
+template <bool kCovered, class FragmentSink>
+void scanScalar(const glm::vec3& s0, const glm::vec3& s1, const glm::vec3& s2,
+                float inv_area, const glm::vec3* attr,
+                int minx, int miny, int maxx, int maxy, FragmentSink& sink) {
+    for (int y = miny; y <= maxy; ++y) {
+        for (int x = minx; x <= maxx; ++x) {
+            glm::vec2 p(x + 0.5f, y + 0.5f);
+
+            float w0 = edgeFunction(glm::vec2(s1), glm::vec2(s2), p) * inv_area;
+            float w1 = edgeFunction(glm::vec2(s2), glm::vec2(s0), p) * inv_area;
+            float w2 = 1.0f - w0 - w1;
+
+            if (!kCovered && (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f)) continue;
+
+            float depth = w0 * s0.z + w1 * s1.z + w2 * s2.z;
+            glm::vec3 a = w0 * attr[0] + w1 * attr[1] + w2 * attr[2];
+            sink(x, y, depth, w0, w1, w2, a);
+        }
+    }
+}
+
+#if SR_HAS_X86_SIMD
+
+// Per-block lane outputs, spilled once and read back by the sink loop.
+struct alignas(32) LaneBlock {
+    float w0[8], w1[8], w2[8], depth[8], ax[8], ay[8], az[8];
+};
+
+template <class FragmentSink>
+inline void emitLanes(const LaneBlock& lb, int mask, int x, int y,
+                      int lanes, FragmentSink& sink) {
+    for (int l = 0; l < lanes; ++l) {
+        if (!(mask & (1 << l))) continue;
+        sink(x + l, y, lb.depth[l], lb.w0[l], lb.w1[l], lb.w2[l],
+             glm::vec3(lb.ax[l], lb.ay[l], lb.az[l]));
+    }
+}
+
+template <bool kCovered, class FragmentSink>
+void scanSse(const glm::vec3& s0, const glm::vec3& s1, const glm::vec3& s2,
+             float inv_area, const glm::vec3* attr,
+             int minx, int miny, int maxx, int maxy, FragmentSink& sink) {
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one  = _mm_set1_ps(1.0f);
+    const __m128 inv  = _mm_set1_ps(inv_area);
+    const __m128 step = _mm_set1_ps(4.0f);
+    // edge0: a = s1, b = s2 ;  edge1: a = s2, b = s0
+    const __m128 e0_ax = _mm_set1_ps(s1.x), e0_dy = _mm_set1_ps(s2.y - s1.y);
+    const __m128 e1_ax = _mm_set1_ps(s2.x), e1_dy = _mm_set1_ps(s0.y - s2.y);
+    const __m128 z0 = _mm_set1_ps(s0.z), z1 = _mm_set1_ps(s1.z), z2 = _mm_set1_ps(s2.z);
+    const __m128 a0x = _mm_set1_ps(attr[0].x), a0y = _mm_set1_ps(attr[0].y), a0z = _mm_set1_ps(attr[0].z);
+    const __m128 a1x = _mm_set1_ps(attr[1].x), a1y = _mm_set1_ps(attr[1].y), a1z = _mm_set1_ps(attr[1].z);
+    const __m128 a2x = _mm_set1_ps(attr[2].x), a2y = _mm_set1_ps(attr[2].y), a2z = _mm_set1_ps(attr[2].z);
+    const __m128 lane_x = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+    LaneBlock lb;
+
+    for (int y = miny; y <= maxy; ++y) {
+        const float py = y + 0.5f;
+        const __m128 e0_row = _mm_set1_ps((py - s1.y) * (s2.x - s1.x));
+        const __m128 e1_row = _mm_set1_ps((py - s2.y) * (s0.x - s2.x));
+        __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(minx)), lane_x);
+        for (int x = minx; x <= maxx; x += 4, px = _mm_add_ps(px, step)) {
+            const __m128 w0 = _mm_mul_ps(_mm_sub_ps(
+                _mm_mul_ps(_mm_sub_ps(px, e0_ax), e0_dy), e0_row), inv);
+            const __m128 w1 = _mm_mul_ps(_mm_sub_ps(
+                _mm_mul_ps(_mm_sub_ps(px, e1_ax), e1_dy), e1_row), inv);
+            const __m128 w2 = _mm_sub_ps(_mm_sub_ps(one, w0), w1);
+            const int lanes = std::min(4, maxx - x + 1);
+            int mask = (1 << lanes) - 1;
+            if constexpr (!kCovered) {
+                // Reject on (w < 0) exactly like the scalar test (NaN lanes pass).
+                const __m128 outside = _mm_or_ps(_mm_or_ps(_mm_cmplt_ps(w0, zero),
+                                                           _mm_cmplt_ps(w1, zero)),
+                                                 _mm_cmplt_ps(w2, zero));
+                mask &= ~_mm_movemask_ps(outside);
+                if (!mask) continue;
+            }
+
+            _mm_store_ps(lb.w0, w0);
+            _mm_store_ps(lb.w1, w1);
+            _mm_store_ps(lb.w2, w2);
+            _mm_store_ps(lb.depth, _mm_add_ps(_mm_add_ps(_mm_mul_ps(w0, z0),
+                                                         _mm_mul_ps(w1, z1)),
+                                              _mm_mul_ps(w2, z2)));
+            _mm_store_ps(lb.ax, _mm_add_ps(_mm_add_ps(_mm_mul_ps(w0, a0x),
+                                                      _mm_mul_ps(w1, a1x)),
+                                           _mm_mul_ps(w2, a2x)));
+            _mm_store_ps(lb.ay, _mm_add_ps(_mm_add_ps(_mm_mul_ps(w0, a0y),
+                                                      _mm_mul_ps(w1, a1y)),
+                                           _mm_mul_ps(w2, a2y)));
+            _mm_store_ps(lb.az, _mm_add_ps(_mm_add_ps(_mm_mul_ps(w0, a0z),
+                                                      _mm_mul_ps(w1, a1z)),
+                                           _mm_mul_ps(w2, a2z)));
+            emitLanes(lb, mask, x, y, lanes, sink);
+        }
+    }
+}
+
+template <bool kCovered, class FragmentSink>
+SR_TARGET_AVX2
+void scanAvx2(const glm::vec3& s0, const glm::vec3& s1, const glm::vec3& s2,
+              float inv_area, const glm::vec3* attr,
+              int minx, int miny, int maxx, int maxy, FragmentSink& sink) {
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one  = _mm256_set1_ps(1.0f);
+    const __m256 inv  = _mm256_set1_ps(inv_area);
+    const __m256 step = _mm256_set1_ps(8.0f);
+    const __m256 e0_ax = _mm256_set1_ps(s1.x), e0_dy = _mm256_set1_ps(s2.y - s1.y);
+    const __m256 e1_ax = _mm256_set1_ps(s2.x), e1_dy = _mm256_set1_ps(s0.y - s2.y);
+    const __m256 z0 = _mm256_set1_ps(s0.z), z1 = _mm256_set1_ps(s1.z), z2 = _mm256_set1_ps(s2.z);
+    const __m256 a0x = _mm256_set1_ps(attr[0].x), a0y = _mm256_set1_ps(attr[0].y), a0z = _mm256_set1_ps(attr[0].z);
+    const __m256 a1x = _mm256_set1_ps(attr[1].x), a1y = _mm256_set1_ps(attr[1].y), a1z = _mm256_set1_ps(attr[1].z);
+    const __m256 a2x = _mm256_set1_ps(attr[2].x), a2y = _mm256_set1_ps(attr[2].y), a2z = _mm256_set1_ps(attr[2].z);
+    const __m256 lane_x = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+    LaneBlock lb;
+
+    for (int y = miny; y <= maxy; ++y) {
+        const float py = y + 0.5f;
+        const __m256 e0_row = _mm256_set1_ps((py - s1.y) * (s2.x - s1.x));
+        const __m256 e1_row = _mm256_set1_ps((py - s2.y) * (s0.x - s2.x));
+        __m256 px = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(minx)), lane_x);
+        for (int x = minx; x <= maxx; x += 8, px = _mm256_add_ps(px, step)) {
+            const __m256 w0 = _mm256_mul_ps(_mm256_sub_ps(
+                _mm256_mul_ps(_mm256_sub_ps(px, e0_ax), e0_dy), e0_row), inv);
+            const __m256 w1 = _mm256_mul_ps(_mm256_sub_ps(
+                _mm256_mul_ps(_mm256_sub_ps(px, e1_ax), e1_dy), e1_row), inv);
+            const __m256 w2 = _mm256_sub_ps(_mm256_sub_ps(one, w0), w1);
+            const int lanes = std::min(8, maxx - x + 1);
+            int mask = (1 << lanes) - 1;
+            if constexpr (!kCovered) {
+                const __m256 outside = _mm256_or_ps(
+                    _mm256_or_ps(_mm256_cmp_ps(w0, zero, _CMP_LT_OQ),
+                                 _mm256_cmp_ps(w1, zero, _CMP_LT_OQ)),
+                    _mm256_cmp_ps(w2, zero, _CMP_LT_OQ));
+                mask &= ~_mm256_movemask_ps(outside);
+                if (!mask) continue;
+            }
+
+            _mm256_store_ps(lb.w0, w0);
+            _mm256_store_ps(lb.w1, w1);
+            _mm256_store_ps(lb.w2, w2);
+            _mm256_store_ps(lb.depth, _mm256_add_ps(
+                _mm256_add_ps(_mm256_mul_ps(w0, z0), _mm256_mul_ps(w1, z1)),
+                _mm256_mul_ps(w2, z2)));
+            _mm256_store_ps(lb.ax, _mm256_add_ps(
+                _mm256_add_ps(_mm256_mul_ps(w0, a0x), _mm256_mul_ps(w1, a1x)),
+                _mm256_mul_ps(w2, a2x)));
+            _mm256_store_ps(lb.ay, _mm256_add_ps(
+                _mm256_add_ps(_mm256_mul_ps(w0, a0y), _mm256_mul_ps(w1, a1y)),
+                _mm256_mul_ps(w2, a2y)));
+            _mm256_store_ps(lb.az, _mm256_add_ps(
+                _mm256_add_ps(_mm256_mul_ps(w0, a0z), _mm256_mul_ps(w1, a1z)),
+                _mm256_mul_ps(w2, a2z)));
+            emitLanes(lb, mask, x, y, lanes, sink);
+        }
+    }
+}
+
+#endif  // SR_HAS_X86_SIMD
+
+template <bool kCovered, class FragmentSink>
+void scanRect(SimdLevel level,
+              const glm::vec3& s0, const glm::vec3& s1, const glm::vec3& s2,
+              float inv_area, const glm::vec3* attr,
+              int minx, int miny, int maxx, int maxy, FragmentSink& sink) {
+    switch (level) {
+#if SR_HAS_X86_SIMD
+        case SimdLevel::kAvx2:
+            scanAvx2<kCovered>(s0, s1, s2, inv_area, attr, minx, miny, maxx, maxy, sink);
+            break;
+        case SimdLevel::kSse:
+            scanSse<kCovered>(s0, s1, s2, inv_area, attr, minx, miny, maxx, maxy, sink);
+            break;
+#endif
+        default:
+            scanScalar<kCovered>(s0, s1, s2, inv_area, attr, minx, miny, maxx, maxy, sink);
+            break;
+    }
+}
+
+// ── Coarse 8x8 block classification ─────────────────────────────────────────
+//
+//  Large triangles are first walked in 8x8 pixel blocks.  The edge functions
+//  are affine, so over a block they reach their extremes at the four corner
+//  pixel centres.  Each corner is evaluated in double and compared against a
+//  margin that bounds the rounding of the float per-pixel evaluation:
+//    every corner  <  -margin on one edge  -> no pixel can pass   (kOutside)
+//    every corner  >  +margin on all edges -> every pixel passes  (kInside)
+//    anything else (incl. NaN)             -> per-pixel test      (kPartial)
+//  Inside blocks skip the coverage compare but still compute w0/w1/w2, depth
+//  and attr with the usual float ops, so the output is bit-identical.
+
+constexpr int kCoarseBlock      = 8;
+constexpr int kCoarseMinBoxArea = 16 * 16;   // smaller boxes: plain scan
+
+enum class BlockCoverage { kOutside, kPartial, kInside };
+
+// Bound on |w_float - w_exact| relative to the magnitudes of the terms that
+// went into it (a handful of float roundings, with a wide safety factor).
+constexpr double kCoverageRelErr = 1.0 / (1 << 20);
+
+BlockCoverage classifyBlock(const glm::vec3& s0, const glm::vec3& s1,
+                            const glm::vec3& s2, float inv_area,
+                            int bx0, int by0, int bx1, int by1) {
+    const double inv = inv_area;
+    const float cx[2] = { bx0 + 0.5f, bx1 + 0.5f };
+    const float cy[2] = { by0 + 0.5f, by1 + 0.5f };
+
+    // Same rounded per-edge constants as the float kernels:
+    //   w = ((px - a.x) * (b.y - a.y) - rowf(py)) * inv_area
+    struct Edge { float ax, ay, dx, dy; };
+    const Edge edges[2] = {
+        { s1.x, s1.y, s2.x - s1.x, s2.y - s1.y },   // w0: a = s1, b = s2
+        { s2.x, s2.y, s0.x - s2.x, s0.y - s2.y },   // w1: a = s2, b = s0
+    };
+
+    double w[2][4];
+    double margin[2] = { 0.0, 0.0 };
+    double wabs_max[2] = { 0.0, 0.0 };
+    for (int e = 0; e < 2; ++e) {
+        const Edge& ed = edges[e];
+        for (int c = 0; c < 4; ++c) {
+            const float py   = cy[c >> 1];
+            const float rowf = (py - ed.ay) * ed.dx;
+            const double col = (static_cast<double>(cx[c & 1]) - ed.ax) * ed.dy;
+            w[e][c] = (col - rowf) * inv;
+            margin[e]    = std::max(margin[e],
+                                    (3.0 * std::abs(col) + std::abs(rowf)) * std::abs(inv));
+            wabs_max[e]  = std::max(wabs_max[e], std::abs(w[e][c]));
+        }
+        margin[e] = margin[e] * kCoverageRelErr;
+    }
+    // w2 = 1 - w0 - w1 inherits both errors plus two more roundings.
+    const double margin2 = margin[0] + margin[1] +
+                           (1.0 + wabs_max[0] + wabs_max[1]) * kCoverageRelErr;
+
+    bool inside = true;
+    bool out0 = true, out1 = true, out2 = true;
+    for (int c = 0; c < 4; ++c) {
+        const double w2 = 1.0 - w[0][c] - w[1][c];
+        inside = inside && w[0][c] > margin[0] && w[1][c] > margin[1] && w2 > margin2;
+        out0 = out0 && w[0][c] < -margin[0];
+        out1 = out1 && w[1][c] < -margin[1];
+        out2 = out2 && w2 < -margin2;
+    }
+    if (out0 || out1 || out2) return BlockCoverage::kOutside;
+    return inside ? BlockCoverage::kInside : BlockCoverage::kPartial;
+}
+
+}  // namespace
+
 // ── rasterTriangle ──────────────────────────────────────────────────────────
 
-void SimpleRasterizer::rasterTriangle(
+bool SimpleRasterizer::setupTriangle(
     const glm::vec4& v0_clip,
     const glm::vec4& v1_clip,
     const glm::vec4& v2_clip,
     int width, int height,
-    std::vector<Fragment>& out_frags) const
+    TriSetup& out) const
 {
     // Near-plane cull (any vertex behind camera).
-    if (v0_clip.w <= 0.0f || v1_clip.w <= 0.0f || v2_clip.w <= 0.0f) return;
+    if (v0_clip.w <= 0.0f || v1_clip.w <= 0.0f || v2_clip.w <= 0.0f) return false;
 
     glm::vec3 ndc0 = perspectiveDivide(v0_clip);
     glm::vec3 ndc1 = perspectiveDivide(v1_clip);
@@ -101,40 +552,315 @@ void SimpleRasterizer::rasterTriangle(
     float fmaxx = std::max({s0.x, s1.x, s2.x});
     float fmaxy = std::max({s0.y, s1.y, s2.y});
 
-    int minx = std::max(0, (int)std::floor(fminx));
-    int miny = std::max(0, (int)std::floor(fminy));
-    int maxx = std::min(width  - 1, (int)std::ceil(fmaxx));
-    int maxy = std::min(height - 1, (int)std::ceil(fmaxy));
+    out.minx = std::max(0, (int)std::floor(fminx));
+    out.miny = std::max(0, (int)std::floor(fminy));
+    out.maxx = std::min(width  - 1, (int)std::ceil(fmaxx));
+    out.maxy = std::min(height - 1, (int)std::ceil(fmaxy));
+    if (out.minx > out.maxx || out.miny > out.maxy) return false;  // off-screen
 
     float area = edgeFunction(glm::vec2(s0), glm::vec2(s1), glm::vec2(s2));
-    if (std::abs(area) < 1e-6f) return;  // degenerate
-    float inv_area = 1.0f / area;
+    if (std::abs(area) < 1e-6f) return false;  // degenerate
 
-    for (int y = miny; y <= maxy; ++y) {
-        for (int x = minx; x <= maxx; ++x) {
-            glm::vec2 p(x + 0.5f, y + 0.5f);
+    out.s0 = s0;
+    out.s1 = s1;
+    out.s2 = s2;
+    out.inv_area = 1.0f / area;
+    return true;
+}
 
-            float w0 = edgeFunction(glm::vec2(s1), glm::vec2(s2), p) * inv_area;
-            float w1 = edgeFunction(glm::vec2(s2), glm::vec2(s0), p) * inv_area;
-            float w2 = 1.0f - w0 - w1;
+template <class FragmentSink>
+void SimpleRasterizer::rasterTriangle(
+    const TriSetup& tri,
+    const glm::vec3* attr,
+    int x0, int y0, int x1, int y1,
+    FragmentSink&& sink) const
+{
+    const int minx = std::max(tri.minx, x0);
+    const int miny = std::max(tri.miny, y0);
+    const int maxx = std::min(tri.maxx, x1);
+    const int maxy = std::min(tri.maxy, y1);
+    if (minx > maxx || miny > maxy) return;
+
+    const SimdLevel level = activeSimdLevel();
+    if ((maxx - minx + 1) * (maxy - miny + 1) < kCoarseMinBoxArea) {
+        scanRect<false>(level, tri.s0, tri.s1, tri.s2, tri.inv_area, attr,
+                        minx, miny, maxx, maxy, sink);
+        return;
+    }
 
-            if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f) continue;
+    // Two-level walk over screen-aligned 8x8 blocks (tiles are multiples of
+    // 8, so blocks never straddle a tile edge).
+    for (int by = miny - miny % kCoarseBlock; by <= maxy; by += kCoarseBlock) {
+        const int y0b = std::max(by, miny);
+        const int y1b = std::min(by + kCoarseBlock - 1, maxy);
+        for (int bx = minx - minx % kCoarseBlock; bx <= maxx; bx += kCoarseBlock) {
+            const int x0b = std::max(bx, minx);
+            const int x1b = std::min(bx + kCoarseBlock - 1, maxx);
+            switch (classifyBlock(tri.s0, tri.s1, tri.s2, tri.inv_area,
+                                  x0b, y0b, x1b, y1b)) {
+                case BlockCoverage::kOutside:
+                    break;
+                case BlockCoverage::kInside:
+                    scanRect<true>(level, tri.s0, tri.s1, tri.s2, tri.inv_area,
+                                   attr, x0b, y0b, x1b, y1b, sink);
+                    break;
+                case BlockCoverage::kPartial:
+                    scanRect<false>(level, tri.s0, tri.s1, tri.s2, tri.inv_area,
+                                    attr, x0b, y0b, x1b, y1b, sink);
+                    break;
+            }
+        }
+    }
+}
 
-            float depth = w0 * s0.z + w1 * s1.z + w2 * s2.z;
+// ── Capture-buffer pool ─────────────────────────────────────────────────────
+//
+//  ViewCaptures handed back through recycle() are parked and re-issued by the
+//  next render of the same size.  Their vectors are refilled with assign(),
+//  which reuses capacity, so an interactive re-render at a fixed resolution
+//  does no buffer allocation.
+//
+//  Retention is bounded two ways: a size that no render has asked for in the
+//  last kPoolStaleRequests acquisitions is dropped (old canvas sizes, a
+//  changed capture resolution), and the whole pool never holds more than
+//  kMaxPooledBytes, evicting the least recently asked-for entries first.
+//
+//  renderPass's own working buffers live in RenderScratch blocks (below),
+//  pooled the same way: a render takes a block, grows it if the frame or
+//  mesh is bigger than anything it held, and hands it back when done.
 
-            Fragment frag;
-            frag.x = x;
-            frag.y = y;
-            frag.depth = depth;
-            frag.bary[0] = w0;
-            frag.bary[1] = w1;
-            frag.bary[2] = w2;
-            out_frags.push_back(frag);
-        }
+namespace {
+
+size_t captureBytes(const ViewCapture& cap) {
+    return cap.depth.capacity() * sizeof(float) +
+           cap.normal_map.capacity() * sizeof(float) +
+           cap.silhouette.capacity() + cap.color.capacity() +
+           cap.color_rgba.capacity();
+}
+
+}  // namespace
+
+void SimpleRasterizer::recycle(ViewCapture&& cap) {
+    // Zero-size captures (e.g. one invalidated by clearing its width) could
+    // never match a request; let their buffers go.
+    if (cap.width <= 0 || cap.height <= 0) return;
+    const size_t bytes = captureBytes(cap);
+    if (bytes == 0 || bytes > kMaxPooledBytes) return;
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    capture_pool_.push_back({ std::move(cap), bytes, pool_requests_ });
+    pool_bytes_ += bytes;
+    trimCapturePool();
+}
+
+void SimpleRasterizer::recycle(std::vector<ViewCapture>&& caps) {
+    for (ViewCapture& cap : caps) recycle(std::move(cap));
+    caps.clear();
+}
+
+void SimpleRasterizer::clearCapturePool() {
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    capture_pool_.clear();
+    capture_pool_.shrink_to_fit();
+    pool_bytes_ = 0;
+    scratch_pool_.clear();
+    scratch_bytes_ = 0;
+}
+
+SimpleRasterizer::CapturePoolStats SimpleRasterizer::capturePoolStats() const {
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    return pool_stats_;
+}
+
+void SimpleRasterizer::trimCapturePool() const {
+    auto drop = [&](size_t i) {
+        pool_bytes_ -= capture_pool_[i].bytes;
+        capture_pool_.erase(capture_pool_.begin() + i);
+    };
+    for (size_t i = capture_pool_.size(); i-- > 0;)
+        if (pool_requests_ - capture_pool_[i].last_request > kPoolStaleRequests) drop(i);
+    while (pool_bytes_ > kMaxPooledBytes) {
+        size_t lru = 0;                                 // earliest wins ties: oldest entry
+        for (size_t i = 1; i < capture_pool_.size(); ++i)
+            if (capture_pool_[i].last_request < capture_pool_[lru].last_request) lru = i;
+        drop(lru);
+    }
+}
+
+ViewCapture SimpleRasterizer::acquireCapture(int width, int height, bool& reused) const {
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    ++pool_requests_;
+    size_t hit = capture_pool_.size();
+    for (size_t i = capture_pool_.size(); i-- > 0;) {
+        PooledCapture& pc = capture_pool_[i];
+        if (pc.cap.width != width || pc.cap.height != height) continue;
+        pc.last_request = pool_requests_;               // this size is still live
+        if (hit == capture_pool_.size()) hit = i;
+    }
+    reused = hit < capture_pool_.size();
+    ViewCapture cap;
+    if (reused) {
+        cap = std::move(capture_pool_[hit].cap);
+        pool_bytes_ -= capture_pool_[hit].bytes;
+        capture_pool_.erase(capture_pool_.begin() + hit);
     }
+    trimCapturePool();
+    return cap;
+}
+
+void SimpleRasterizer::addPoolStats(const CapturePoolStats& delta) const {
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    pool_stats_.captures_reused    += delta.captures_reused;
+    pool_stats_.captures_allocated += delta.captures_allocated;
+    pool_stats_.bytes_reused       += delta.bytes_reused;
+    pool_stats_.bytes_allocated    += delta.bytes_allocated;
+    pool_stats_.scratch_reused     += delta.scratch_reused;
+    pool_stats_.scratch_allocated  += delta.scratch_allocated;
+    pool_stats_.scratch_bytes_reused    += delta.scratch_bytes_reused;
+    pool_stats_.scratch_bytes_allocated += delta.scratch_bytes_allocated;
 }
 
 // ── render ──────────────────────────────────────────────────────────────────
+//
+//  Sort-middle tiled rasteriser:
+//
+//    0. Transform (parallel over vertex chunks): every vertex is projected
+//       ONCE into an SoA clip-space cache; triangles sharing a vertex reuse
+//       it instead of re-transforming all three corners per triangle.
+//    1. Setup + bin (parallel over triangle chunks): project every triangle,
+//       cull it, and count / record which kTileSize² screen tiles its pixel
+//       bounding box touches.  Bins are laid out tile-major, chunk-minor, so
+//       each tile's list holds its triangles in ORIGINAL submission order.
+//    2. Raster (parallel over tiles): every tile depth-tests and shades its
+//       own triangles in that order into its own pixels.  In deferred mode
+//       the tile keeps a visibility buffer (triangle id + barycentrics) and
+//       shades each covered pixel once after all its triangles are scanned.
+//
+//  Tiles own disjoint pixels and see their triangles in the same order as a
+//  single serial walk, and the per-pixel arithmetic is unchanged, so the
+//  depth / normal / silhouette / colour buffers are bit-identical to the
+//  one-thread rasteriser (ties still go to the earliest triangle).
+// ───────────────────────────────────────────────────────────────────────────
+
+namespace {
+
+constexpr int kTileSize       = 64;     // pixels per tile edge
+constexpr int kTrisPerChunk   = 4096;   // binning work item
+constexpr int kVertsPerChunk  = 16384;  // vertex-transform work item
+constexpr uint32_t kNoTriangle = 0xFFFFFFFFu;  // empty visibility-buffer texel
+
+// Per-view clip-space positions, structure-of-arrays.
+struct ClipSpaceVerts {
+    std::vector<float> x, y, z, w;
+
+    glm::vec4 operator[](uint32_t i) const { return {x[i], y[i], z[i], w[i]}; }
+};
+
+// Resize `buf` to n copies of `value`, booking the bytes as reused when the
+// existing capacity covers them (assign() then only fills).
+template <class T>
+void fillBuffer(std::vector<T>& buf, size_t n, T value,
+                SimpleRasterizer::CapturePoolStats& stats) {
+    const uint64_t bytes = static_cast<uint64_t>(n) * sizeof(T);
+    if (buf.capacity() >= n) stats.bytes_reused    += bytes;
+    else                     stats.bytes_allocated += bytes;
+    buf.assign(n, value);
+}
+
+// Grow `buf` to at least n elements and return its storage, booking the
+// bytes as scratch reuse when it was already big enough.  Scratch never
+// shrinks, so a steady render size never reallocates or re-initialises it;
+// callers fill whatever part they read.
+template <class T>
+T* scratchBuffer(std::vector<T>& buf, size_t n,
+                 SimpleRasterizer::CapturePoolStats& stats) {
+    const uint64_t bytes = static_cast<uint64_t>(n) * sizeof(T);
+    if (buf.size() >= n) {
+        stats.scratch_bytes_reused += bytes;
+    } else {
+        stats.scratch_bytes_allocated += bytes;
+        buf.resize(n);
+    }
+    return buf.data();
+}
+
+// Weighted-blended OIT accumulation target (see renderOIT).
+struct OITPixel {
+    float accum_r = 0.0f;
+    float accum_g = 0.0f;
+    float accum_b = 0.0f;
+    float accum_a = 0.0f;  // sum of alpha * w(z)
+    float reveal  = 1.0f;  // product of (1 - alpha)
+};
+
+// `out` must already hold at least positions.size() entries per lane.
+void transformVertices(const std::vector<glm::vec3>& positions,
+                       const glm::mat4& vp, ClipSpaceVerts& out) {
+    const size_t n = positions.size();
+    const int nchunks = static_cast<int>((n + kVertsPerChunk - 1) / kVertsPerChunk);
+    parallelFor(nchunks, [&](int c) {
+        const size_t v0 = static_cast<size_t>(c) * kVertsPerChunk;
+        const size_t v1 = std::min(n, v0 + kVertsPerChunk);
+        for (size_t v = v0; v < v1; ++v) {
+            const glm::vec4 p = vp * glm::vec4(positions[v], 1.0f);
+            out.x[v] = p.x; out.y[v] = p.y; out.z[v] = p.z; out.w[v] = p.w;
+        }
+    });
+}
+
+}  // namespace
+
+// Working buffers of one renderPass.  Each render holds one block for its
+// whole duration (concurrent renders hold different blocks); the deferred
+// visibility buffer is frame-sized and split into fixed kTileSize^2 slots,
+// one per tile, because tiles own disjoint pixels.
+struct SimpleRasterizer::RenderScratch {
+    ClipSpaceVerts         clip;
+    std::vector<TriSetup>  setups;
+    std::vector<uint8_t>   visible;
+    std::vector<uint32_t>  bin_count;
+    std::vector<uint32_t>  bin_offset;
+    std::vector<uint32_t>  tile_begin;
+    std::vector<uint32_t>  bins;
+    std::vector<OITPixel>  oit;
+    std::vector<uint32_t>  vis_tri;
+    std::vector<glm::vec3> vis_bary;
+
+    size_t bytes() const {
+        return (clip.x.capacity() + clip.y.capacity() + clip.z.capacity() +
+                clip.w.capacity()) * sizeof(float) +
+               setups.capacity() * sizeof(TriSetup) + visible.capacity() +
+               (bin_count.capacity() + bin_offset.capacity() + tile_begin.capacity() +
+                bins.capacity() + vis_tri.capacity()) * sizeof(uint32_t) +
+               oit.capacity() * sizeof(OITPixel) +
+               vis_bary.capacity() * sizeof(glm::vec3);
+    }
+};
+
+SimpleRasterizer::SimpleRasterizer() = default;
+SimpleRasterizer::~SimpleRasterizer() = default;
+
+std::unique_ptr<SimpleRasterizer::RenderScratch>
+SimpleRasterizer::acquireScratch(bool& reused) const {
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        reused = !scratch_pool_.empty();
+        if (reused) {
+            std::unique_ptr<RenderScratch> scratch = std::move(scratch_pool_.back());
+            scratch_pool_.pop_back();
+            scratch_bytes_ -= scratch->bytes();
+            return scratch;
+        }
+    }
+    return std::make_unique<RenderScratch>();
+}
+
+void SimpleRasterizer::releaseScratch(std::unique_ptr<RenderScratch> scratch) const {
+    const size_t bytes = scratch->bytes();
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    if (scratch_bytes_ + bytes > kMaxScratchBytes) return;   // freed on return
+    scratch_bytes_ += bytes;
+    scratch_pool_.push_back(std::move(scratch));
+}
 
 ViewCapture SimpleRasterizer::render(
     const TriangleMesh& mesh,
@@ -142,9 +868,25 @@ ViewCapture SimpleRasterizer::render(
     const glm::mat4& view,
     const glm::mat4& proj,
     float azimuth_deg,
-    float elevation_deg) const
+    float elevation_deg,
+    bool  sample_texture) const
 {
-    ViewCapture cap;
+    return renderPass(mesh, width, height, view, proj,
+                      azimuth_deg, elevation_deg, -1.0f, sample_texture);
+}
+
+ViewCapture SimpleRasterizer::renderPass(
+    const TriangleMesh& mesh,
+    int width, int height,
+    const glm::mat4& view,
+    const glm::mat4& proj,
+    float azimuth_deg,
+    float elevation_deg,
+    float oit_alpha,
+    bool  sample_texture) const
+{
+    bool reused = false;
+    ViewCapture cap = acquireCapture(width, height, reused);
     cap.width  = width;
     cap.height = height;
     cap.view   = view;
@@ -153,21 +895,32 @@ ViewCapture SimpleRasterizer::render(
     cap.azimuth_deg  = azimuth_deg;
     cap.elevation_deg = elevation_deg;
 
-    const int npix = width * height;
-    cap.depth.assign(npix, 1.0f);
-    cap.normal_map.assign(npix * 3, 0.0f);
-    cap.silhouette.assign(npix, 0);
-    cap.color.assign(npix * 3, 0);
-
-    // Depth buffer for z-test.
-    std::vector<float> zbuf(npix, 1.0f);
+    // Weighted-blended transparency is accumulated in the same traversal.
+    const bool oit_on = oit_alpha >= 0.0f;
+
+    CapturePoolStats pool_delta;
+    (reused ? pool_delta.captures_reused : pool_delta.captures_allocated) = 1;
+
+    const int npix = std::max(width * height, 0);
+    fillBuffer(cap.depth,      npix,     1.0f,       pool_delta);
+    fillBuffer(cap.normal_map, npix * 3, 0.0f,       pool_delta);
+    fillBuffer(cap.silhouette, npix,     uint8_t(0), pool_delta);
+    fillBuffer(cap.color,      npix * 3, uint8_t(0), pool_delta);
+    if (oit_on) fillBuffer(cap.color_rgba, npix * 4, uint8_t(0), pool_delta);
+    else        cap.color_rgba.clear();              // keeps capacity pooled
+    if (npix <= 0) {
+        addPoolStats(pool_delta);
+        return cap;
+    }
 
-    // Per-pixel normal accumulator (written in the z-test pass).
-    // We store the winning triangle's interpolated normal.
-    struct PixelData {
-        glm::vec3 normal{0.0f};
-    };
-    std::vector<PixelData> pixel_data(npix);
+    bool scratch_reused = false;
+    std::unique_ptr<RenderScratch> scratch = acquireScratch(scratch_reused);
+    (scratch_reused ? pool_delta.scratch_reused : pool_delta.scratch_allocated) = 1;
+    OITPixel* oit = nullptr;
+    if (oit_on) {
+        oit = scratchBuffer(scratch->oit, npix, pool_delta);
+        std::fill_n(oit, npix, OITPixel{});
+    }
 
     glm::mat4 vp = proj * view;
 
@@ -177,106 +930,333 @@ ViewCapture SimpleRasterizer::render(
 
     const size_t vert_count = mesh.positions.size();
     const bool has_normals  = mesh.normals.size() == vert_count;
-    const bool has_uvs      = mesh.texcoords.size() == vert_count;
-    const bool has_tex      = !mesh.base_color_texture.empty();
-    const bool has_vcol     = mesh.vertex_colors.size() == vert_count;
-
-    std::vector<Fragment> frags;
+    // Textured shading multiplies the texture by the per-vertex tint; the
+    // default shades from the baked vertex colours and never touches it.
+    const bool textured     = sample_texture && !mesh.base_color_texture.empty() &&
+                              mesh.texcoords.size() == vert_count;
+    const std::vector<glm::vec3>& vcols =
+        textured ? mesh.texture_tints : mesh.vertex_colors;
+    const bool has_vcol     = vcols.size() == vert_count;
+
+    // ── 0. Vertex transform ──
+    ClipSpaceVerts& clip = scratch->clip;
+    scratchBuffer(clip.x, vert_count, pool_delta);
+    scratchBuffer(clip.y, vert_count, pool_delta);
+    scratchBuffer(clip.z, vert_count, pool_delta);
+    scratchBuffer(clip.w, vert_count, pool_delta);
+    transformVertices(mesh.positions, vp, clip);
+
+    // ── 1. Setup + binning ──
+    const int tiles_x = (width  + kTileSize - 1) / kTileSize;
+    const int tiles_y = (height + kTileSize - 1) / kTileSize;
+    const int ntiles  = tiles_x * tiles_y;
 
     const size_t tri_count = mesh.indices.size() / 3;
-    for (size_t t = 0; t < tri_count; ++t) {
+    const int nchunks = static_cast<int>((tri_count + kTrisPerChunk - 1) / kTrisPerChunk);
+
+    const size_t nbins = static_cast<size_t>(nchunks) * ntiles;
+    TriSetup* setups  = scratchBuffer(scratch->setups, tri_count, pool_delta);
+    uint8_t*  visible = scratchBuffer(scratch->visible, tri_count, pool_delta);
+    std::fill_n(visible, tri_count, uint8_t(0));
+    // bin_count[c * ntiles + tile] = triangles of chunk c touching tile.
+    uint32_t* bin_count = scratchBuffer(scratch->bin_count, nbins, pool_delta);
+    std::fill_n(bin_count, nbins, 0u);
+
+    auto chunkRange = [&](int c, size_t& t0, size_t& t1) {
+        t0 = static_cast<size_t>(c) * kTrisPerChunk;
+        t1 = std::min(tri_count, t0 + kTrisPerChunk);
+    };
+
+    parallelFor(nchunks, [&](int c) {
+        size_t t0, t1;
+        chunkRange(c, t0, t1);
+        uint32_t* counts = &bin_count[static_cast<size_t>(c) * ntiles];
+        for (size_t t = t0; t < t1; ++t) {
+            uint32_t i0 = mesh.indices[t * 3 + 0];
+            uint32_t i1 = mesh.indices[t * 3 + 1];
+            uint32_t i2 = mesh.indices[t * 3 + 2];
+            if (i0 >= vert_count || i1 >= vert_count || i2 >= vert_count) continue;
+
+            TriSetup& tri = setups[t];
+            if (!setupTriangle(clip[i0], clip[i1], clip[i2], width, height, tri))
+                continue;
+            visible[t] = 1;
+            for (int ty = tri.miny / kTileSize; ty <= tri.maxy / kTileSize; ++ty)
+                for (int tx = tri.minx / kTileSize; tx <= tri.maxx / kTileSize; ++tx)
+                    ++counts[ty * tiles_x + tx];
+        }
+    });
+
+    // Tile-major, chunk-minor prefix sum -> contiguous, ordered bins.
+    uint32_t* bin_offset = scratchBuffer(scratch->bin_offset, nbins, pool_delta);
+    uint32_t* tile_begin = scratchBuffer(scratch->tile_begin, ntiles + 1, pool_delta);
+    {
+        uint32_t run = 0;
+        for (int tile = 0; tile < ntiles; ++tile) {
+            tile_begin[tile] = run;
+            for (int c = 0; c < nchunks; ++c) {
+                const size_t k = static_cast<size_t>(c) * ntiles + tile;
+                bin_offset[k] = run;
+                run += bin_count[k];
+            }
+        }
+        tile_begin[ntiles] = run;
+    }
+    uint32_t* bins = scratchBuffer(scratch->bins, tile_begin[ntiles], pool_delta);
+
+    parallelFor(nchunks, [&](int c) {
+        size_t t0, t1;
+        chunkRange(c, t0, t1);
+        uint32_t* cursor = &bin_offset[static_cast<size_t>(c) * ntiles];
+        for (size_t t = t0; t < t1; ++t) {
+            if (!visible[t]) continue;
+            const TriSetup& tri = setups[t];
+            for (int ty = tri.miny / kTileSize; ty <= tri.maxy / kTileSize; ++ty)
+                for (int tx = tri.minx / kTileSize; tx <= tri.maxx / kTileSize; ++tx)
+                    bins[cursor[ty * tiles_x + tx]++] = static_cast<uint32_t>(t);
+        }
+    });
+
+    // Per-triangle shading inputs.
+    struct TriAttribs {
+        glm::vec3 nrm[3];
+        glm::vec2 uv[3];
+        glm::vec3 vc[3];
+        float     tex_lod;                  // constant across the triangle
+    };
+    auto gatherAttribs = [&](uint32_t t, TriAttribs& a) {
         uint32_t i0 = mesh.indices[t * 3 + 0];
         uint32_t i1 = mesh.indices[t * 3 + 1];
         uint32_t i2 = mesh.indices[t * 3 + 2];
-        if (i0 >= vert_count || i1 >= vert_count || i2 >= vert_count) continue;
-
-        glm::vec4 c0 = vp * glm::vec4(mesh.positions[i0], 1.0f);
-        glm::vec4 c1 = vp * glm::vec4(mesh.positions[i1], 1.0f);
-        glm::vec4 c2 = vp * glm::vec4(mesh.positions[i2], 1.0f);
-
-        frags.clear();
-        rasterTriangle(c0, c1, c2, width, height, frags);
 
         // Compute face normal if per-vertex normals unavailable.
-        glm::vec3 n0, n1, n2;
         if (has_normals) {
-            n0 = mesh.normals[i0];
-            n1 = mesh.normals[i1];
-            n2 = mesh.normals[i2];
+            a.nrm[0] = mesh.normals[i0];
+            a.nrm[1] = mesh.normals[i1];
+            a.nrm[2] = mesh.normals[i2];
         } else {
             glm::vec3 face_n = glm::normalize(
                 glm::cross(mesh.positions[i1] - mesh.positions[i0],
                            mesh.positions[i2] - mesh.positions[i0]));
-            n0 = n1 = n2 = face_n;
+            a.nrm[0] = a.nrm[1] = a.nrm[2] = face_n;
         }
 
         // Fetch per-vertex UVs for texture sampling.
-        glm::vec2 uv0(0.0f), uv1(0.0f), uv2(0.0f);
-        if (has_uvs) {
-            uv0 = mesh.texcoords[i0];
-            uv1 = mesh.texcoords[i1];
-            uv2 = mesh.texcoords[i2];
+        a.uv[0] = a.uv[1] = a.uv[2] = glm::vec2(0.0f);
+        if (textured) {
+            a.uv[0] = mesh.texcoords[i0];
+            a.uv[1] = mesh.texcoords[i1];
+            a.uv[2] = mesh.texcoords[i2];
+        }
+
+        // Barycentrics are affine in screen space, so d(uv)/dx and d(uv)/dy
+        // are per-triangle constants; they pick the texture mip level.
+        a.tex_lod = 0.0f;
+        if (textured) {
+            const TriSetup& tri = setups[t];
+            const float dw0dx =  (tri.s2.y - tri.s1.y) * tri.inv_area;
+            const float dw0dy = -(tri.s2.x - tri.s1.x) * tri.inv_area;
+            const float dw1dx =  (tri.s0.y - tri.s2.y) * tri.inv_area;
+            const float dw1dy = -(tri.s0.x - tri.s2.x) * tri.inv_area;
+            const glm::vec2 e0 = a.uv[0] - a.uv[2];
+            const glm::vec2 e1 = a.uv[1] - a.uv[2];
+            a.tex_lod = mesh.base_color_texture.mipLod(dw0dx * e0 + dw1dx * e1,
+                                                       dw0dy * e0 + dw1dy * e1);
         }
 
         // Fetch per-vertex colors.
-        glm::vec3 vc0(1.0f), vc1(1.0f), vc2(1.0f);
+        a.vc[0] = a.vc[1] = a.vc[2] = glm::vec3(1.0f);
         if (has_vcol) {
-            vc0 = mesh.vertex_colors[i0];
-            vc1 = mesh.vertex_colors[i1];
-            vc2 = mesh.vertex_colors[i2];
+            a.vc[0] = vcols[i0];
+            a.vc[1] = vcols[i1];
+            a.vc[2] = vcols[i2];
         }
+    };
 
-        for (auto& f : frags) {
-            int idx = f.y * width + f.x;
-            if (idx < 0 || idx >= npix) continue;
-            if (f.depth < zbuf[idx]) {
-                zbuf[idx] = f.depth;
-                cap.depth[idx] = f.depth;
-                cap.silhouette[idx] = 255;
-
-                glm::vec3 n = glm::normalize(
-                    f.bary[0] * n0 + f.bary[1] * n1 + f.bary[2] * n2);
-                pixel_data[idx].normal = n;
-
-                cap.normal_map[idx * 3 + 0] = n.x;
-                cap.normal_map[idx * 3 + 1] = n.y;
-                cap.normal_map[idx * 3 + 2] = n.z;
-
-                // Double-sided: flip normal for back faces.
-                float ndot = glm::dot(n, cam_fwd);
-                bool is_front = (ndot >= 0.0f);
-                if (!is_front) n = -n;
-
-                float diffuse = std::clamp(glm::dot(n, cam_fwd), 0.0f, 1.0f);
-                float brightness = 0.4f + 0.6f * diffuse;
-
-                // Base color: texture > vertex color > normal-mapped fallback.
-                glm::vec3 col;
-                if (has_tex && has_uvs) {
-                    glm::vec2 uv = f.bary[0] * uv0 + f.bary[1] * uv1 + f.bary[2] * uv2;
-                    col = mesh.base_color_texture.sample(uv);
-                    if (has_vcol) {
-                        glm::vec3 vc = f.bary[0] * vc0 + f.bary[1] * vc1 + f.bary[2] * vc2;
-                        col *= vc;
-                    }
-                } else if (has_vcol) {
-                    col = f.bary[0] * vc0 + f.bary[1] * vc1 + f.bary[2] * vc2;
-                } else {
-                    col = n * 0.5f + 0.5f;
+    // Shade one fragment whose (un-flipped) unit normal is n_geom.  `opaque`
+    // writes cap.color, `accumulate` adds the fragment to the OIT buffers.
+    auto shadeFragment = [&](int idx, const TriAttribs& a, float depth,
+                             float w0, float w1, float w2,
+                             const glm::vec3& n_geom,
+                             bool opaque, bool accumulate) {
+        glm::vec3 n = n_geom;
+
+        // Double-sided: flip normal for back faces.
+        float ndot = glm::dot(n, cam_fwd);
+        bool is_front = (ndot >= 0.0f);
+        if (!is_front) n = -n;
+
+        float diffuse = std::clamp(glm::dot(n, cam_fwd), 0.0f, 1.0f);
+        float brightness = 0.4f + 0.6f * diffuse;
+
+        // Base color: texture > vertex color > normal-mapped fallback
+        // (the fallback differs between the opaque and OIT outputs).
+        glm::vec3 base(0.0f);
+        const bool has_base = textured || has_vcol;
+        if (textured) {
+            glm::vec2 uv = w0 * a.uv[0] + w1 * a.uv[1] + w2 * a.uv[2];
+            base = mesh.base_color_texture.sample(uv, a.tex_lod);
+            if (has_vcol) {
+                glm::vec3 vc = w0 * a.vc[0] + w1 * a.vc[1] + w2 * a.vc[2];
+                base *= vc;
+            }
+        } else if (has_vcol) {
+            base = w0 * a.vc[0] + w1 * a.vc[1] + w2 * a.vc[2];
+        }
+
+        if (opaque) {
+            glm::vec3 col = has_base ? base : n * 0.5f + 0.5f;
+            col *= brightness;
+
+            cap.color[idx * 3 + 0] = static_cast<uint8_t>(
+                std::clamp(col.r * 255.0f, 0.0f, 255.0f));
+            cap.color[idx * 3 + 1] = static_cast<uint8_t>(
+                std::clamp(col.g * 255.0f, 0.0f, 255.0f));
+            cap.color[idx * 3 + 2] = static_cast<uint8_t>(
+                std::clamp(col.b * 255.0f, 0.0f, 255.0f));
+        }
+
+        if (accumulate) {
+            glm::vec3 col = has_base ? base : n_geom * 0.5f + 0.5f;
+            col *= brightness;
+
+            // Color tint: green for front faces, red for back faces.
+            if (is_front) {
+                col.g = std::clamp(col.g + 0.20f, 0.0f, 1.0f);
+            } else {
+                col.r = std::clamp(col.r + 0.20f, 0.0f, 1.0f);
+                col.b *= 0.7f;  // slightly desaturate blue on back faces
+            }
+
+            // Weighted blend: w(z) = clamp(1e3 * (1-z)^3, 1e-2, 3e3)
+            float one_minus_z = std::clamp(1.0f - depth, 0.0f, 1.0f);
+            float w = std::clamp(1000.0f * one_minus_z * one_minus_z * one_minus_z,
+                                 0.01f, 3000.0f);
+
+            float aw = oit_alpha * w;
+            oit[idx].accum_r += col.r * aw;
+            oit[idx].accum_g += col.g * aw;
+            oit[idx].accum_b += col.b * aw;
+            oit[idx].accum_a += aw;
+            oit[idx].reveal  *= (1.0f - oit_alpha);
+        }
+    };
+
+    // OIT must shade every fragment, so the visibility buffer only applies
+    // to the opaque-only pass.
+    const bool deferred = deferred_shading_ && !oit_on;
+    constexpr size_t kTilePixels = static_cast<size_t>(kTileSize) * kTileSize;
+    uint32_t*  vis_tri  = nullptr;
+    glm::vec3* vis_bary = nullptr;
+    if (deferred) {
+        vis_tri  = scratchBuffer(scratch->vis_tri,  kTilePixels * ntiles, pool_delta);
+        vis_bary = scratchBuffer(scratch->vis_bary, kTilePixels * ntiles, pool_delta);
+    }
+    addPoolStats(pool_delta);
+
+    // ── 2. Per-tile raster + depth test (+ forward shade) ──
+    parallelFor(ntiles, [&](int tile) {
+        const int tx = tile % tiles_x, ty = tile / tiles_x;
+        const int x0 = tx * kTileSize, y0 = ty * kTileSize;
+        const int x1 = std::min(width,  x0 + kTileSize) - 1;
+        const int y1 = std::min(height, y0 + kTileSize) - 1;
+        const int tw = x1 - x0 + 1;
+
+        // Visibility buffer for this tile (its slot of the frame-sized one):
+        // winning triangle + barycentrics.
+        uint32_t*  tile_tri  = nullptr;
+        glm::vec3* tile_bary = nullptr;
+        if (deferred) {
+            tile_tri  = vis_tri  + kTilePixels * tile;
+            tile_bary = vis_bary + kTilePixels * tile;
+            std::fill_n(tile_tri, static_cast<size_t>(tw) * (y1 - y0 + 1), kNoTriangle);
+        }
+
+        TriAttribs attribs;
+        for (uint32_t b = tile_begin[tile]; b < tile_begin[tile + 1]; ++b) {
+            const uint32_t t = bins[b];
+            gatherAttribs(t, attribs);
+
+            rasterTriangle(setups[t], attribs.nrm, x0, y0, x1, y1,
+                           [&](int x, int y, float depth,
+                               float w0, float w1, float w2,
+                               const glm::vec3& n_interp) {
+                int idx = y * width + x;
+                const bool depth_pass = depth < cap.depth[idx];
+                if (!depth_pass && !oit_on) return;
+
+                glm::vec3 n = glm::normalize(n_interp);
+                if (depth_pass) {
+                    cap.depth[idx] = depth;
+                    cap.silhouette[idx] = 255;
+
+                    cap.normal_map[idx * 3 + 0] = n.x;
+                    cap.normal_map[idx * 3 + 1] = n.y;
+                    cap.normal_map[idx * 3 + 2] = n.z;
                 }
 
-                col *= brightness;
+                if (deferred) {
+                    const int v = (y - y0) * tw + (x - x0);
+                    tile_tri[v]  = t;
+                    tile_bary[v] = glm::vec3(w0, w1, w2);
+                    return;
+                }
+                shadeFragment(idx, attribs, depth, w0, w1, w2, n,
+                              depth_pass, oit_on);
+            });
+        }
+        if (!deferred) return;
+
+        // ── 2b. Deferred shade: once per visible pixel ──
+        uint32_t gathered = kNoTriangle;
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                const int v = (y - y0) * tw + (x - x0);
+                const uint32_t t = tile_tri[v];
+                if (t == kNoTriangle) continue;
+                if (t != gathered) {
+                    gatherAttribs(t, attribs);
+                    gathered = t;
+                }
+                const int idx = y * width + x;
+                const glm::vec3 n(cap.normal_map[idx * 3 + 0],
+                                  cap.normal_map[idx * 3 + 1],
+                                  cap.normal_map[idx * 3 + 2]);
+                const glm::vec3& bary = tile_bary[v];
+                shadeFragment(idx, attribs, cap.depth[idx],
+                              bary.x, bary.y, bary.z, n, true, false);
+            }
+        }
+    });
 
-                cap.color[idx * 3 + 0] = static_cast<uint8_t>(
-                    std::clamp(col.r * 255.0f, 0.0f, 255.0f));
-                cap.color[idx * 3 + 1] = static_cast<uint8_t>(
-                    std::clamp(col.g * 255.0f, 0.0f, 255.0f));
-                cap.color[idx * 3 + 2] = static_cast<uint8_t>(
-                    std::clamp(col.b * 255.0f, 0.0f, 255.0f));
+    // ── 3. Resolve OIT into RGBA ──
+    if (oit_on) {
+        for (int i = 0; i < npix; ++i) {
+            auto& p = oit[i];
+            float final_alpha = 1.0f - p.reveal;
+
+            if (final_alpha < 1e-4f) {
+                // No fragments hit this pixel — transparent background.
+                cap.color_rgba[i * 4 + 0] = 0;
+                cap.color_rgba[i * 4 + 1] = 0;
+                cap.color_rgba[i * 4 + 2] = 0;
+                cap.color_rgba[i * 4 + 3] = 0;
+            } else {
+                float inv_a = 1.0f / std::max(p.accum_a, 1e-4f);
+                float r = std::clamp(p.accum_r * inv_a, 0.0f, 1.0f);
+                float g = std::clamp(p.accum_g * inv_a, 0.0f, 1.0f);
+                float b = std::clamp(p.accum_b * inv_a, 0.0f, 1.0f);
+                float a = std::clamp(final_alpha, 0.0f, 1.0f);
+
+                cap.color_rgba[i * 4 + 0] = static_cast<uint8_t>(r * 255.0f);
+                cap.color_rgba[i * 4 + 1] = static_cast<uint8_t>(g * 255.0f);
+                cap.color_rgba[i * 4 + 2] = static_cast<uint8_t>(b * 255.0f);
+                cap.color_rgba[i * 4 + 3] = static_cast<uint8_t>(a * 255.0f);
             }
         }
     }
 
+    releaseScratch(std::move(scratch));
     return cap;
 }
 
@@ -299,6 +1279,11 @@ ViewCapture SimpleRasterizer::render(
 //
 //  Weight function w(z) dampens distant fragments so near surfaces
 //  dominate the blend.
+//
+//  The accumulation runs inside renderPass's tile raster alongside the
+//  opaque depth test, so geometry is set up, binned and scanned only once.
+//  Each tile still sees its triangles in submission order, so the per-pixel
+//  sums match a serial triangle walk exactly.
 // ───────────────────────────────────────────────────────────────────────────
 
 ViewCapture SimpleRasterizer::renderOIT(
@@ -308,18 +1293,19 @@ ViewCapture SimpleRasterizer::renderOIT(
     const glm::mat4& proj,
     float mesh_alpha,
     float azimuth_deg,
-    float elevation_deg) const
+    float elevation_deg,
+    bool  sample_texture) const
 {
-    // First do a normal opaque render (fills color, depth, silhouette, normals).
-    ViewCapture cap = render(mesh, width, height, view, proj,
-                             azimuth_deg, elevation_deg);
-
-    const int npix = width * height;
     mesh_alpha = std::clamp(mesh_alpha, 0.0f, 1.0f);
 
     // At full opacity, skip OIT and use the opaque depth-tested result directly.
     if (mesh_alpha >= 0.99f) {
-        cap.color_rgba.resize(npix * 4);
+        ViewCapture cap = render(mesh, width, height, view, proj,
+                                 azimuth_deg, elevation_deg, sample_texture);
+        const int npix = std::max(width * height, 0);
+        CapturePoolStats pool_delta;
+        fillBuffer(cap.color_rgba, npix * 4, uint8_t(0), pool_delta);
+        addPoolStats(pool_delta);
         for (int i = 0; i < npix; ++i) {
             cap.color_rgba[i * 4 + 0] = cap.color[i * 3 + 0];
             cap.color_rgba[i * 4 + 1] = cap.color[i * 3 + 1];
@@ -329,152 +1315,10 @@ ViewCapture SimpleRasterizer::renderOIT(
         return cap;
     }
 
-    // Now build the OIT composite into color_rgba.
-
-    // Accumulation buffers (float precision).
-    struct OITPixel {
-        float accum_r = 0.0f;
-        float accum_g = 0.0f;
-        float accum_b = 0.0f;
-        float accum_a = 0.0f;  // sum of alpha * w(z)
-        float reveal  = 1.0f;  // product of (1 - alpha)
-    };
-    std::vector<OITPixel> oit(npix);
-
-    glm::mat4 vp = proj * view;
-
-    // Camera forward direction in world space (for front/back shading).
-    glm::mat4 inv_view = glm::inverse(view);
-    glm::vec3 cam_fwd  = -glm::vec3(inv_view[2]);  // camera looks along -Z
-
-    const size_t vert_count = mesh.positions.size();
-    const bool has_normals  = mesh.normals.size() == vert_count;
-    const bool has_uvs      = mesh.texcoords.size() == vert_count;
-    const bool has_tex      = !mesh.base_color_texture.empty();
-    const bool has_vcol     = mesh.vertex_colors.size() == vert_count;
-
-    std::vector<Fragment> frags;
-
-    const size_t tri_count = mesh.indices.size() / 3;
-    for (size_t t = 0; t < tri_count; ++t) {
-        uint32_t i0 = mesh.indices[t * 3 + 0];
-        uint32_t i1 = mesh.indices[t * 3 + 1];
-        uint32_t i2 = mesh.indices[t * 3 + 2];
-        if (i0 >= vert_count || i1 >= vert_count || i2 >= vert_count) continue;
-
-        glm::vec4 c0 = vp * glm::vec4(mesh.positions[i0], 1.0f);
-        glm::vec4 c1 = vp * glm::vec4(mesh.positions[i1], 1.0f);
-        glm::vec4 c2 = vp * glm::vec4(mesh.positions[i2], 1.0f);
-
-        frags.clear();
-        rasterTriangle(c0, c1, c2, width, height, frags);
-
-        // Normals.
-        glm::vec3 n0, n1, n2;
-        if (has_normals) {
-            n0 = mesh.normals[i0]; n1 = mesh.normals[i1]; n2 = mesh.normals[i2];
-        } else {
-            glm::vec3 face_n = glm::normalize(
-                glm::cross(mesh.positions[i1] - mesh.positions[i0],
-                           mesh.positions[i2] - mesh.positions[i0]));
-            n0 = n1 = n2 = face_n;
-        }
-
-        glm::vec2 uv0(0.0f), uv1(0.0f), uv2(0.0f);
-        if (has_uvs) {
-            uv0 = mesh.texcoords[i0]; uv1 = mesh.texcoords[i1]; uv2 = mesh.texcoords[i2];
-        }
-
-        glm::vec3 vc0(1.0f), vc1(1.0f), vc2(1.0f);
-        if (has_vcol) {
-            vc0 = mesh.vertex_colors[i0]; vc1 = mesh.vertex_colors[i1]; vc2 = mesh.vertex_colors[i2];
-        }
-
-        for (auto& f : frags) {
-            int idx = f.y * width + f.x;
-            if (idx < 0 || idx >= npix) continue;
-
-            // Compute fragment color (same logic as opaque render).
-            glm::vec3 n = glm::normalize(
-                f.bary[0] * n0 + f.bary[1] * n1 + f.bary[2] * n2);
-            glm::vec3 col;
-            if (has_tex && has_uvs) {
-                glm::vec2 uv = f.bary[0] * uv0 + f.bary[1] * uv1 + f.bary[2] * uv2;
-                col = mesh.base_color_texture.sample(uv);
-                if (has_vcol) {
-                    glm::vec3 vc = f.bary[0] * vc0 + f.bary[1] * vc1 + f.bary[2] * vc2;
-                    col *= vc;
-                }
-            } else if (has_vcol) {
-                col = f.bary[0] * vc0 + f.bary[1] * vc1 + f.bary[2] * vc2;
-            } else {
-                col = n * 0.5f + 0.5f;
-            }
-
-            // Double-sided: detect front/back, then flip normal for
-            // back faces so both sides get proper lighting.
-            float ndot = glm::dot(n, cam_fwd);
-            bool is_front = (ndot >= 0.0f);
-
-            // Flip normal for back faces so lighting is symmetric.
-            if (!is_front) n = -n;
-
-            // Simple diffuse brightness using the (now always front-facing) normal.
-            float diffuse = std::clamp(glm::dot(n, cam_fwd), 0.0f, 1.0f);
-            float brightness = 0.4f + 0.6f * diffuse;
-            col *= brightness;
-
-            // Color tint: green for front faces, red for back faces.
-            if (is_front) {
-                col.g = std::clamp(col.g + 0.20f, 0.0f, 1.0f);
-            } else {
-                col.r = std::clamp(col.r + 0.20f, 0.0f, 1.0f);
-                col.b *= 0.7f;  // slightly desaturate blue on back faces
-            }
-
-            float frag_alpha = mesh_alpha;
-
-            // Weighted blend: w(z) = clamp(1e3 * (1-z)^3, 1e-2, 3e3)
-            float one_minus_z = std::clamp(1.0f - f.depth, 0.0f, 1.0f);
-            float w = std::clamp(1000.0f * one_minus_z * one_minus_z * one_minus_z,
-                                 0.01f, 3000.0f);
-
-            float aw = frag_alpha * w;
-            oit[idx].accum_r += col.r * aw;
-            oit[idx].accum_g += col.g * aw;
-            oit[idx].accum_b += col.b * aw;
-            oit[idx].accum_a += aw;
-            oit[idx].reveal  *= (1.0f - frag_alpha);
-        }
-    }
-
-    // Resolve OIT into RGBA.
-    cap.color_rgba.resize(npix * 4);
-    for (int i = 0; i < npix; ++i) {
-        auto& p = oit[i];
-        float final_alpha = 1.0f - p.reveal;
-
-        if (final_alpha < 1e-4f) {
-            // No fragments hit this pixel — transparent background.
-            cap.color_rgba[i * 4 + 0] = 0;
-            cap.color_rgba[i * 4 + 1] = 0;
-            cap.color_rgba[i * 4 + 2] = 0;
-            cap.color_rgba[i * 4 + 3] = 0;
-        } else {
-            float inv_a = 1.0f / std::max(p.accum_a, 1e-4f);
-            float r = std::clamp(p.accum_r * inv_a, 0.0f, 1.0f);
-            float g = std::clamp(p.accum_g * inv_a, 0.0f, 1.0f);
-            float b = std::clamp(p.accum_b * inv_a, 0.0f, 1.0f);
-            float a = std::clamp(final_alpha, 0.0f, 1.0f);
-
-            cap.color_rgba[i * 4 + 0] = static_cast<uint8_t>(r * 255.0f);
-            cap.color_rgba[i * 4 + 1] = static_cast<uint8_t>(g * 255.0f);
-            cap.color_rgba[i * 4 + 2] = static_cast<uint8_t>(b * 255.0f);
-            cap.color_rgba[i * 4 + 3] = static_cast<uint8_t>(a * 255.0f);
-        }
-    }
-
-    return cap;
+    // One traversal fills the opaque buffers (color, depth, silhouette,
+    // normals) and the OIT accumulation, then resolves into color_rgba.
+    return renderPass(mesh, width, height, view, proj,
+                      azimuth_deg, elevation_deg, mesh_alpha, sample_texture);
 }
 
 // ── captureOrbit ────────────────────────────────────────────────────────────
@@ -487,7 +1331,6 @@ std::vector<ViewCapture> SimpleRasterizer::captureOrbit(
     float radius_mult) const
 {
     std::vector<ViewCapture> captures;
-    captures.reserve(num_views);
 
     // Orbit centre and radius from the mesh bounds.
     glm::vec3 centre = (mesh.bbox_min + mesh.bbox_max) * 0.5f;
@@ -507,7 +1350,11 @@ std::vector<ViewCapture> SimpleRasterizer::captureOrbit(
     glm::mat4 proj = glm::perspective(fov, aspect, z_near, z_far);
     proj[1][1] *= -1.0f;   // Vulkan y-flip convention (kept for consistency)
 
-    for (int i = 0; i < num_views; ++i) {
+    // Views are independent: render them concurrently, each into its own
+    // slot so the result keeps the deterministic azimuth order.  The tile
+    // passes inside render() run serially per worker while nested here.
+    captures.resize(std::max(num_views, 0));
+    parallelFor(num_views, [&](int i) {
         float azimuth_deg = 360.0f * i / num_views;
         float az_rad = glm::radians(azimuth_deg);
 
@@ -518,10 +1365,9 @@ std::vector<ViewCapture> SimpleRasterizer::captureOrbit(
 
         glm::mat4 view = glm::lookAt(eye, centre, glm::vec3(0, 1, 0));
 
-        captures.push_back(
-            render(mesh, resolution, resolution, view, proj,
-                   azimuth_deg, elevation_deg));
-    }
+        captures[i] = render(mesh, resolution, resolution, view, proj,
+                             azimuth_deg, elevation_deg);
+    });
 
     return captures;
 }
@@ -580,7 +1426,11 @@ glm::mat4 gltfNodeLocal(const tinygltf::Node& n) {
     return T * R * S;
 }
 
-bool loadGltfGeometry(const std::string& path, TriangleMesh& out) {
+// with_texture also keeps TEXCOORD_0, the first decoded base-colour image
+// (as base_color_texture, mips built) and each primitive's baseColorFactor
+// as its texture tint.  Primitives with another image still sample the
+// first one; callers only want the texturing cost, not an exact look.
+bool loadGltfGeometry(const std::string& path, TriangleMesh& out, bool with_texture) {
     tinygltf::Model model;
     tinygltf::TinyGLTF loader;
     std::string err, warn;
@@ -635,6 +1485,50 @@ bool loadGltfGeometry(const std::string& path, TriangleMesh& out) {
                 out.positions.push_back(glm::vec3(wp));
             }
 
+            if (with_texture) {
+                auto uit = prim.attributes.find("TEXCOORD_0");
+                if (uit != prim.attributes.end()) {
+                    const auto& ua  = model.accessors[uit->second];
+                    const auto& ubv = model.bufferViews[ua.bufferView];
+                    const auto& ubf = model.buffers[ubv.buffer];
+                    const float* uv = reinterpret_cast<const float*>(
+                        ubf.data.data() + ubv.byteOffset + ua.byteOffset);
+                    const size_t ustride = ubv.byteStride ? ubv.byteStride / sizeof(float) : 2;
+                    for (size_t i = 0; i < ua.count; ++i)
+                        out.texcoords.push_back(glm::vec2(uv[i * ustride + 0],
+                                                          uv[i * ustride + 1]));
+                }
+                out.texcoords.resize(out.positions.size(), glm::vec2(0.0f));
+
+                glm::vec3 tint(1.0f);
+                if (prim.material >= 0 && prim.material < (int)model.materials.size()) {
+                    const auto& pbr = model.materials[prim.material].pbrMetallicRoughness;
+                    if (pbr.baseColorFactor.size() >= 3)
+                        tint = glm::vec3((float)pbr.baseColorFactor[0],
+                                         (float)pbr.baseColorFactor[1],
+                                         (float)pbr.baseColorFactor[2]);
+                    const int tex = pbr.baseColorTexture.index;
+                    const int img = (tex >= 0 && tex < (int)model.textures.size())
+                                        ? model.textures[tex].source : -1;
+                    if (out.base_color_texture.empty() &&
+                        img >= 0 && img < (int)model.images.size()) {
+                        const auto& im = model.images[img];
+                        if (im.width > 0 && im.height > 0 && im.component >= 3 &&
+                            !im.image.empty()) {
+                            SimpleTexture& t = out.base_color_texture;
+                            t.width    = im.width;
+                            t.height   = im.height;
+                            t.channels = 3;
+                            t.pixels.resize((size_t)im.width * im.height * 3);
+                            for (size_t px = 0; px < (size_t)im.width * im.height; ++px)
+                                for (int c = 0; c < 3; ++c)
+                                    t.pixels[px * 3 + c] = im.image[px * im.component + c];
+                        }
+                    }
+                }
+                out.texture_tints.resize(out.positions.size(), tint);
+            }
+
             if (prim.indices >= 0) {
                 const auto& ia = model.accessors[prim.indices];
                 const auto& ib = model.bufferViews[ia.bufferView];
@@ -659,6 +1553,12 @@ bool loadGltfGeometry(const std::string& path, TriangleMesh& out) {
             }
         }
     }
+    if (out.base_color_texture.empty()) {
+        out.texcoords.clear();
+        out.texture_tints.clear();
+    } else {
+        out.base_color_texture.buildMips();
+    }
     return !out.positions.empty() && !out.indices.empty();
 }
 
@@ -702,7 +1602,7 @@ bool loadFbxGeometry(const std::string& path, TriangleMesh& out) {
 
 }  // anonymous namespace
 
-bool loadMeshForThumbnail(const std::string& path, TriangleMesh& out) {
+bool loadMeshForThumbnail(const std::string& path, TriangleMesh& out, bool with_texture) {
     out = TriangleMesh{};
     std::string ext;
     {
@@ -712,7 +1612,7 @@ bool loadMeshForThumbnail(const std::string& path, TriangleMesh& out) {
     }
 
     bool ok = false;
-    if (ext == ".gltf" || ext == ".glb") ok = loadGltfGeometry(path, out);
+    if (ext == ".gltf" || ext == ".glb") ok = loadGltfGeometry(path, out, with_texture);
     else if (ext == ".fbx")              ok = loadFbxGeometry(path, out);
     if (!ok || out.empty()) return false;
 
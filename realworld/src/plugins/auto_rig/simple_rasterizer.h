@@ -1,5 +1,8 @@
 #pragma once
 #include "rig_types.h"
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <vector>
 #include <glm/glm.hpp>
 
@@ -16,15 +19,20 @@ namespace auto_rig {
 //    • simple diffuse-shaded colour
 //
 //  Used to produce multi-view captures of a character model without
-//  touching the Vulkan renderer.  Not fast, but self-contained.
+//  touching the Vulkan renderer.  Self-contained; the opaque pass bins
+//  triangles into screen tiles and rasterises the tiles in parallel.
 // ---------------------------------------------------------------------------
 class SimpleRasterizer {
 public:
-    SimpleRasterizer() = default;
-    ~SimpleRasterizer() = default;
+    SimpleRasterizer();
+    ~SimpleRasterizer();
 
     // Render the mesh from a specific camera (opaque).
     // Returns a fully populated ViewCapture.
+    // Colour comes from the mesh's baked vertex colours.  With sample_texture
+    // the base-colour texture (if any) is sampled per pixel with mip LOD and
+    // multiplied by TriangleMesh::texture_tints instead; interactive previews
+    // use that, while captures fed to the rig model keep the baked colours.
     ViewCapture render(
         const TriangleMesh& mesh,
         int   width,
@@ -32,7 +40,8 @@ public:
         const glm::mat4& view,
         const glm::mat4& proj,
         float azimuth_deg  = 0.0f,
-        float elevation_deg = 0.0f) const;
+        float elevation_deg = 0.0f,
+        bool  sample_texture = false) const;
 
     // Render with Weighted Blended Order-Independent Transparency.
     // mesh_alpha in [0,1] controls the mesh opacity.  All fragments
@@ -48,11 +57,13 @@ public:
         const glm::mat4& proj,
         float mesh_alpha   = 0.6f,
         float azimuth_deg  = 0.0f,
-        float elevation_deg = 0.0f) const;
+        float elevation_deg = 0.0f,
+        bool  sample_texture = false) const;
 
     // Generate an orbit of cameras looking at the mesh bounding-box centre.
     // Returns `num_views` ViewCaptures evenly spaced in azimuth.
     // `radius_mult` controls camera distance as a multiplier of mesh extent.
+    // Views are rendered concurrently; the result is always in azimuth order.
     std::vector<ViewCapture> captureOrbit(
         const TriangleMesh& mesh,
         int   num_views,
@@ -60,20 +71,121 @@ public:
         float elevation_deg = 15.0f,
         float radius_mult   = 1.2f) const;
 
+    // Visibility-buffer mode for the opaque pass: the raster only records the
+    // front-most triangle id + barycentrics per pixel and colour is shaded
+    // once per visible pixel afterwards, so shading cost no longer scales
+    // with overdraw.  Every output buffer is identical in both modes.
+    void setDeferredShading(bool enabled) { deferred_shading_ = enabled; }
+    bool deferredShading() const { return deferred_shading_; }
+
+    // ── Capture-buffer pool ──
+    // Interactive previews re-render at the same resolution every frame.
+    // Captures handed back through recycle() keep their buffers in a small
+    // pool; the next render at the same width x height refills that storage
+    // instead of allocating.  The pool is capped at kMaxPooledBytes and drops
+    // sizes nobody has asked for in a while.  Safe to use from concurrent
+    // renders.
+    //
+    // Each render's working memory (clip-space vertices, triangle setups and
+    // bins, the OIT accumulator, the deferred visibility buffer) comes from a
+    // second pool of per-render scratch blocks, one per concurrent render,
+    // capped at kMaxScratchBytes.  clearCapturePool() empties both.
+    struct CapturePoolStats {
+        uint64_t captures_reused    = 0;
+        uint64_t captures_allocated = 0;
+        uint64_t bytes_reused       = 0;     // buffer bytes served from capacity
+        uint64_t bytes_allocated    = 0;     // buffer bytes that needed new storage
+        uint64_t scratch_reused     = 0;     // renders that took a pooled scratch block
+        uint64_t scratch_allocated  = 0;     // renders that had to create one
+        uint64_t scratch_bytes_reused    = 0;
+        uint64_t scratch_bytes_allocated = 0;
+    };
+    void recycle(ViewCapture&& cap);
+    void recycle(std::vector<ViewCapture>&& caps);
+    void clearCapturePool();
+    CapturePoolStats capturePoolStats() const;
+
 private:
-    // Rasterise a single triangle into the depth buffer + attribute buffers.
-    struct Fragment {
-        int   x, y;
-        float depth;
-        float bary[3];
+    static constexpr size_t   kMaxPooledBytes    = size_t(256) << 20;
+    static constexpr uint64_t kPoolStaleRequests = 64;   // renders before an unasked size goes
+    static constexpr size_t   kMaxScratchBytes   = size_t(256) << 20;
+
+    struct RenderScratch;                     // renderPass working buffers (.cpp)
+
+    struct PooledCapture {
+        ViewCapture cap;
+        size_t      bytes = 0;                // buffer capacity held
+        uint64_t    last_request = 0;         // pool_requests_ when its size was last asked for
     };
 
-    void rasterTriangle(
+    // Pooled capture of exactly width x height, or a fresh one.
+    ViewCapture acquireCapture(int width, int height, bool& reused) const;
+    // Drop stale sizes, then the least recently asked-for entries until the
+    // pool fits kMaxPooledBytes.  Caller holds pool_mutex_.
+    void        trimCapturePool() const;
+    void        addPoolStats(const CapturePoolStats& delta) const;
+
+    // Pooled scratch block, or a fresh one; hand it back when the render ends.
+    std::unique_ptr<RenderScratch> acquireScratch(bool& reused) const;
+    void        releaseScratch(std::unique_ptr<RenderScratch> scratch) const;
+
+    // Shared traversal behind render() and renderOIT().  With oit_alpha < 0
+    // only the opaque buffers are produced; otherwise every fragment is also
+    // accumulated at that opacity and resolved into color_rgba.
+    ViewCapture renderPass(
+        const TriangleMesh& mesh,
+        int   width,
+        int   height,
+        const glm::mat4& view,
+        const glm::mat4& proj,
+        float azimuth_deg,
+        float elevation_deg,
+        float oit_alpha,
+        bool  sample_texture) const;
+
+    // Screen-space triangle after projection, near-plane and degenerate
+    // culling.  The bounding box is already clamped to the viewport.
+    struct TriSetup {
+        glm::vec3 s0, s1, s2;                // screen x, y and [0,1] depth
+        float     inv_area;
+        int       minx, miny, maxx, maxy;    // inclusive pixel bounds
+    };
+
+    // Returns false if the triangle produces no fragments.
+    bool setupTriangle(
         const glm::vec4& v0_clip,
         const glm::vec4& v1_clip,
         const glm::vec4& v2_clip,
         int width, int height,
-        std::vector<Fragment>& out_frags) const;
+        TriSetup& out) const;
+
+    // Scan `tri` inside the inclusive pixel rect [x0,x1] x [y0,y1] (a screen
+    // tile) and call
+    //     sink(x, y, depth, w0, w1, w2, attr_interp)
+    // inline for every covered pixel, where attr_interp is the barycentric
+    // blend of the per-vertex vec3 `attr[3]` (the un-normalised shading
+    // normal).  Coverage, depth and attr are evaluated in 4/8-wide SSE/AVX2
+    // blocks when the CPU supports them (scalar otherwise); large triangles
+    // are first walked in 8x8 blocks so empty blocks are skipped and fully
+    // covered ones skip the coverage test.  All paths are bit-identical.
+    // The sink does the depth test and shading, so no per-triangle fragment
+    // list is ever materialised.
+    template <class FragmentSink>
+    void rasterTriangle(
+        const TriSetup& tri,
+        const glm::vec3* attr,
+        int x0, int y0, int x1, int y1,
+        FragmentSink&& sink) const;
+
+    bool deferred_shading_ = false;
+
+    mutable std::mutex                 pool_mutex_;
+    mutable std::vector<PooledCapture> capture_pool_;
+    mutable size_t                     pool_bytes_    = 0;
+    mutable uint64_t                   pool_requests_ = 0;
+    mutable CapturePoolStats           pool_stats_;
+    mutable std::vector<std::unique_ptr<RenderScratch>> scratch_pool_;
+    mutable size_t                     scratch_bytes_ = 0;
 };
 
 // ---------------------------------------------------------------------------
@@ -84,7 +196,11 @@ private:
 //  does NOT reject already-skinned meshes and ignores skeletons/materials — it
 //  just wants triangles to rasterise into an icon.  Returns false if the file
 //  can't be read or yields no triangles.
-bool loadMeshForThumbnail(const std::string& path, TriangleMesh& out);
+//  with_texture additionally keeps glTF UVs and the base-colour texture (with
+//  mips) so renders with sample_texture exercise texturing; FBX stays
+//  geometry-only.
+bool loadMeshForThumbnail(const std::string& path, TriangleMesh& out,
+                          bool with_texture = false);
 
 }  // namespace auto_rig
 }  // namespace plugins
\ No newline at end of file
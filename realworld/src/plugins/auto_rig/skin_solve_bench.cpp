@@ -0,0 +1,217 @@
+// ---------------------------------------------------------------------------
+//  autorig_solve_bench – headless benchmark for the skin-weight solvers.
+//
+//  Builds a synthetic tube body (a straight joint chain inside a wavy
+//  cylinder) at a fixed grid of sizes and runs computeSkinWeightsAlgo on it
+//  with each linear-solver path:
+//
+//    * direct  — factor-once sparse LDL^T (the default)
+//    * jacobi  — CG with the Jacobi preconditioner (options.direct = false)
+//    * amg     — CG with the smoothed-aggregation AMG preconditioner
+//
+//  for Bone Heat and Biharmonic, and Geodesic with each distance method:
+//
+//    * dijkstra — edge-graph Dijkstra (the default)
+//    * heat     — factored heat method (options.heat_geodesic)
+//
+//  The mesh, skeleton and repetitions are fixed, so two builds run on the
+//  same machine produce comparable numbers.  The topology is built once per
+//  size, outside the timed region.  Results are printed to stdout as JSON
+//  (progress goes to stderr):
+//
+//    { "meshes": [ { "vertices", "triangles", "joints", "cases": [
+//        { "algo", "solver", "ms_median", "ms_min", "setup_ms", "solve_ms",
+//          "cg_iters_max", "cg_iters_total", "amg_levels" } ] } ],
+//      "threads", "reps" }
+//
+//  setup_ms / solve_ms / iteration counts come from SkinSolveStats of the
+//  median repetition; cg_iters_max is the worst joint (it hits the CG cap
+//  when a preconditioner stalls).
+//
+//  Usage:
+//    autorig_solve_bench [--verts 2500,10000,40000,160000] [--joints 10]
+//                        [--solvers direct,jacobi,amg,dijkstra,heat] [--reps 3]
+//  No window, GPU or assets are needed.
+// ---------------------------------------------------------------------------
+
+#include "skinning_weights.h"
+#include "parallel_for.h"
+#include "json.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace plugins::auto_rig;
+using nlohmann::json;
+
+namespace {
+
+std::vector<int> parseList(const char* s) {
+    std::vector<int> out;
+    for (const char* p = s; *p;) {
+        char* end = nullptr;
+        long v = std::strtol(p, &end, 10);
+        if (end == p) break;
+        if (v > 0) out.push_back(static_cast<int>(v));
+        p = (*end == ',') ? end + 1 : end;
+    }
+    return out;
+}
+
+std::vector<std::string> parseNames(const char* s) {
+    std::vector<std::string> out;
+    std::string cur;
+    for (const char* p = s;; ++p) {
+        if (*p == ',' || *p == '\0') {
+            if (!cur.empty()) out.push_back(cur);
+            cur.clear();
+            if (*p == '\0') break;
+        } else {
+            cur += *p;
+        }
+    }
+    return out;
+}
+
+// ~target_verts vertices on an open 1.8-unit cylinder along +Y whose radius
+// wobbles along the length (so the operators are not trivially uniform).
+TriangleMesh tubeBody(int target_verts) {
+    const int seg   = std::max(8, static_cast<int>(std::lround(std::sqrt(target_verts / 4.0))));
+    const int rings = std::max(2, target_verts / seg);
+    TriangleMesh mesh;
+    mesh.positions.reserve(static_cast<size_t>(seg) * rings);
+    for (int r = 0; r < rings; ++r) {
+        const float t = static_cast<float>(r) / (rings - 1);
+        const float radius = 0.15f + 0.03f * std::sin(t * 19.0f);
+        for (int s = 0; s < seg; ++s) {
+            const float a = 6.2831853f * s / seg;
+            mesh.positions.push_back(glm::vec3(radius * std::cos(a), 1.8f * t,
+                                               radius * std::sin(a)));
+        }
+    }
+    for (int r = 0; r + 1 < rings; ++r) {
+        for (int s = 0; s < seg; ++s) {
+            const uint32_t a = r * seg + s, b = r * seg + (s + 1) % seg;
+            const uint32_t c = a + seg, d = b + seg;
+            mesh.indices.insert(mesh.indices.end(), { a, c, b, b, c, d });
+        }
+    }
+    return mesh;
+}
+
+// Joint chain up the tube axis.
+Skeleton tubeSkeleton(int joints) {
+    Skeleton sk;
+    sk.joints.resize(joints);
+    for (int j = 0; j < joints; ++j) {
+        sk.joints[j].name     = "j" + std::to_string(j);
+        sk.joints[j].parent   = j - 1;
+        sk.joints[j].position = glm::vec3(0.0f, 1.8f * (j + 0.5f) / joints, 0.0f);
+    }
+    sk.root = 0;
+    return sk;
+}
+
+json timeCase(const MeshTopology& topo, const Skeleton& sk, SkinWeightAlgo algo,
+              const std::string& solver, int reps) {
+    SkinSolveOptions opt;
+    opt.direct = solver == "direct" || solver == "heat";
+    opt.amg_bone_heat = opt.amg_biharmonic = solver == "amg";
+    opt.heat_geodesic = solver == "heat";
+
+    struct Run { double ms; SkinSolveStats st; };
+    std::vector<Run> runs;
+    for (int r = 0; r < reps; ++r) {
+        Run run;
+        auto t0 = std::chrono::steady_clock::now();
+        SkinWeights w = computeSkinWeightsAlgo(topo, sk, algo, 4, opt, &run.st);
+        auto t1 = std::chrono::steady_clock::now();
+        run.ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+        runs.push_back(run);
+    }
+    std::sort(runs.begin(), runs.end(), [](const Run& a, const Run& b) { return a.ms < b.ms; });
+    const Run& med = runs[runs.size() / 2];
+
+    std::fprintf(stderr, "[Bench]   %-11s %-7s %9.1f ms  setup %8.1f  solve %8.1f  "
+                 "iters max %5d\n", skinWeightAlgoName(algo), solver.c_str(), med.ms,
+                 med.st.setup_ms, med.st.solve_ms, med.st.cg_iters_max);
+    return {
+        { "algo",           skinWeightAlgoName(algo) },
+        { "solver",         solver },
+        { "ms_median",      med.ms },
+        { "ms_min",         runs.front().ms },
+        { "setup_ms",       med.st.setup_ms },
+        { "solve_ms",       med.st.solve_ms },
+        { "cg_iters_max",   med.st.cg_iters_max },
+        { "cg_iters_total", med.st.cg_iters_total },
+        { "amg_levels",     med.st.amg_levels },
+    };
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::vector<int> sizes = { 2500, 10000, 40000, 160000 };
+    std::vector<std::string> solvers = { "direct", "jacobi", "amg", "dijkstra", "heat" };
+    int joints = 10;
+    int reps = 3;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if      (a == "--verts"   && i + 1 < argc) sizes   = parseList(argv[++i]);
+        else if (a == "--solvers" && i + 1 < argc) solvers = parseNames(argv[++i]);
+        else if (a == "--joints"  && i + 1 < argc) joints  = std::max(2, std::atoi(argv[++i]));
+        else if (a == "--reps"    && i + 1 < argc) reps    = std::max(1, std::atoi(argv[++i]));
+        else {
+            std::fprintf(stderr,
+                "usage: %s [--verts a,b,..] [--joints n] "
+                "[--solvers direct,jacobi,amg,dijkstra,heat] [--reps n]\n", argv[0]);
+            return (a == "--help" || a == "-h") ? 0 : 1;
+        }
+    }
+
+    const Skeleton sk = tubeSkeleton(joints);
+    // Linear-solver paths for the two solves, distance methods for Geodesic.
+    const std::vector<std::string> linear   = { "direct", "jacobi", "amg" };
+    const std::vector<std::string> distance = { "dijkstra", "heat" };
+    const std::pair<SkinWeightAlgo, const std::vector<std::string>*> algos[] = {
+        { SkinWeightAlgo::kBoneHeat,   &linear },
+        { SkinWeightAlgo::kBiharmonic, &linear },
+        { SkinWeightAlgo::kGeodesic,   &distance },
+    };
+    json meshes = json::array();
+
+    for (int target : sizes) {
+        const TriangleMesh mesh = tubeBody(target);
+        const MeshTopology topo = buildMeshTopology(mesh);
+        std::fprintf(stderr, "[Bench] tube: %zu vertices, %zu triangles, %d joints\n",
+                     mesh.positions.size(), mesh.indices.size() / 3, joints);
+
+        json cases = json::array();
+        for (const auto& [algo, paths] : algos)
+            for (const std::string& solver : *paths)
+                if (std::find(solvers.begin(), solvers.end(), solver) != solvers.end())
+                    cases.push_back(timeCase(topo, sk, algo, solver, reps));
+
+        meshes.push_back({
+            { "vertices",  mesh.positions.size() },
+            { "triangles", mesh.indices.size() / 3 },
+            { "joints",    joints },
+            { "cases",     std::move(cases) },
+        });
+    }
+
+    json out = {
+        { "meshes",  std::move(meshes) },
+        { "threads", workerCount() },
+        { "reps",    reps },
+    };
+    std::printf("%s\n", out.dump(2).c_str());
+    return 0;
+}
@@ -1,23 +1,51 @@
 // ============================================================================
 //  skinning_weights.cpp  —  see header for the high-level description.
 //
-//  Everything here is self-contained: glm + the C++ standard library only.
+//  Everything here is self-contained: glm + the C++ standard library only
+//  (plus the header-only parallelFor helper; per-joint solves run on it).
 //  Numerics are done in double; results are written back as the float
 //  VertexSkinData expected by the exporter.
 // ============================================================================
 
 #include "plugins/auto_rig/skinning_weights.h"
+#include "plugins/auto_rig/mesh_topology.h"
+#include "plugins/auto_rig/parallel_for.h"
 
 #include <glm/glm.hpp>
 
 #include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <cstdint>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
 #include <limits>
+#include <mutex>
 #include <queue>
-#include <unordered_map>
+#include <tuple>
 #include <vector>
 
+#if defined(__x86_64__) || defined(_M_X64)
+#define SW_HAS_X86_SIMD 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#else
+#define SW_HAS_X86_SIMD 0
+#endif
+
+// The AVX bone-distance kernel is compiled for that ISA only (GCC/Clang need
+// the per-function target).  FMA is deliberately NOT enabled so every lane
+// rounds exactly like distPointSegment.
+#if SW_HAS_X86_SIMD && (defined(__GNUC__) || defined(__clang__))
+#define SW_TARGET_AVX __attribute__((target("avx")))
+#else
+#define SW_TARGET_AVX
+#endif
+
 namespace plugins {
 namespace auto_rig {
 namespace {
@@ -26,6 +54,12 @@ using dvec3 = glm::dvec3;
 
 constexpr double kInf = std::numeric_limits<double>::infinity();
 
+using Clock = std::chrono::steady_clock;
+
+double msSince(Clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
 // ---------------------------------------------------------------------------
 //  Small geometry helper: distance from point p to segment [a,b].
 // ---------------------------------------------------------------------------
@@ -78,300 +112,1263 @@ std::vector<JointBones> buildJointBones(const Skeleton& sk, double scale) {
     return jb;
 }
 
-// Distance from point p to joint j (min over its outgoing segments).
-double distToJoint(const dvec3& p, const JointBones& jb) {
-    double d = kInf;
-    for (auto& s : jb.segs) d = std::min(d, distPointSegment(p, s.first, s.second));
-    return d;
+// ---------------------------------------------------------------------------
+//  Nearest-bone queries.
+//
+//  Every outgoing segment of every joint goes into a small BVH (median split
+//  on the widest axis, leaves of up to kSegLanes segments stored SoA).  A
+//  query walks it nearest-box-first and skips subtrees whose box is already
+//  farther than the current answer, so cost grows with log(#bones) rather
+//  than #bones — what matters for finger / facial rigs.
+//
+//  Leaves are evaluated kSegLanes segments at a time (AVX when the CPU has
+//  it).  Each lane does the same double operations in the same order as
+//  distPointSegment, so distances, and therefore every assignment, are
+//  bit-identical to the brute-force loop over all joints.
+// ---------------------------------------------------------------------------
+constexpr int kSegLanes = 4;
+
+#if SW_HAS_X86_SIMD
+bool skinSimdEnabled() {
+    static const bool enabled = [] {
+        bool avx = false;
+#if defined(_MSC_VER)
+        int r[4];
+        __cpuid(r, 1);
+        const bool osxsave = (r[2] & (1 << 27)) != 0;
+        avx = osxsave && (r[2] & (1 << 28)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+#else
+        __builtin_cpu_init();
+        avx = __builtin_cpu_supports("avx");
+#endif
+        // AUTORIG_SKIN_SIMD=scalar forces the scalar kernel (A/B timing).
+        const char* env = std::getenv("AUTORIG_SKIN_SIMD");
+        return avx && !(env && std::strcmp(env, "scalar") == 0);
+    }();
+    return enabled;
 }
+#endif
+
+struct BoneBvh {
+    struct Node {
+        dvec3 lo, hi;
+        int   left = -1, right = -1;           // children (inner nodes)
+        int   leaf = -1;                       // leaf index, -1 for inner nodes
+    };
+    std::vector<Node> nodes;                   // nodes[0] is the root
+    // SoA segments, kSegLanes per leaf; padding lanes have joint == -1.
+    std::vector<double> ax, ay, az, abx, aby, abz, len2;
+    std::vector<dvec3>  a, b;                  // scalar-kernel copy
+    std::vector<int>    joint;
+    double slack = 0.0;                        // box-distance rounding guard
+    int    njoints = 0;
 
-// Index (and distance) of the nearest joint to point p.
-std::pair<int, double> nearestJoint(const dvec3& p, const std::vector<JointBones>& jbs) {
-    int best = 0;
-    double bd = kInf;
-    for (int j = 0; j < (int)jbs.size(); ++j) {
-        double d = distToJoint(p, jbs[j]);
-        if (d < bd) { bd = d; best = j; }
+    BoneBvh(const std::vector<JointBones>& jbs, double scale) {
+        struct Seg { dvec3 a, b, c; int j; };
+        std::vector<Seg> segs;
+        for (int j = 0; j < (int)jbs.size(); ++j)
+            for (auto& s : jbs[j].segs) segs.push_back({ s.first, s.second, 0.5 * (s.first + s.second), j });
+        slack = 1e-9 * scale;
+        njoints = (int)jbs.size();
+        if (segs.empty()) return;
+        nodes.reserve(2 * segs.size());
+        build(segs, 0, (int)segs.size());
     }
-    return {best, bd};
-}
+
+    template <class Seg>
+    int build(std::vector<Seg>& segs, int lo, int hi) {
+        const int id = (int)nodes.size();
+        nodes.emplace_back();
+        dvec3 blo(kInf), bhi(-kInf), clo(kInf), chi(-kInf);
+        for (int i = lo; i < hi; ++i) {
+            blo = glm::min(blo, glm::min(segs[i].a, segs[i].b));
+            bhi = glm::max(bhi, glm::max(segs[i].a, segs[i].b));
+            clo = glm::min(clo, segs[i].c);
+            chi = glm::max(chi, segs[i].c);
+        }
+        nodes[id].lo = blo;
+        nodes[id].hi = bhi;
+        if (hi - lo <= kSegLanes) {
+            nodes[id].leaf = (int)joint.size() / kSegLanes;
+            for (int l = 0; l < kSegLanes; ++l) {
+                // Padding lanes sit far away (squares stay finite) and are
+                // never reported.
+                const bool real = lo + l < hi;
+                const dvec3 sa = real ? segs[lo + l].a : dvec3(1e150);
+                const dvec3 sb = real ? segs[lo + l].b : dvec3(1e150);
+                const dvec3 ab = sb - sa;
+                a.push_back(sa); b.push_back(sb);
+                ax.push_back(sa.x); ay.push_back(sa.y); az.push_back(sa.z);
+                abx.push_back(ab.x); aby.push_back(ab.y); abz.push_back(ab.z);
+                len2.push_back(glm::dot(ab, ab));
+                joint.push_back(real ? segs[lo + l].j : -1);
+            }
+            return id;
+        }
+        const dvec3 ext = chi - clo;
+        const int axis = (ext.x >= ext.y && ext.x >= ext.z) ? 0 : (ext.y >= ext.z ? 1 : 2);
+        const int mid = (lo + hi) / 2;
+        std::nth_element(segs.begin() + lo, segs.begin() + mid, segs.begin() + hi,
+                         [axis](const Seg& x, const Seg& y) { return x.c[axis] < y.c[axis]; });
+        const int l = build(segs, lo, mid);
+        const int r = build(segs, mid, hi);
+        nodes[id].left = l;
+        nodes[id].right = r;
+        return id;
+    }
+
+    // Lower bound on the distance from p to anything inside node n.
+    double boxDist(const Node& n, const dvec3& p) const {
+        const dvec3 d = glm::max(glm::max(n.lo - p, p - n.hi), dvec3(0.0));
+        return std::max(0.0, glm::length(d) - slack);
+    }
+
+    // Distances from p to the kSegLanes segments of `leaf`.
+    void leafDist(int leaf, const dvec3& p, double* out) const {
+        const int s = leaf * kSegLanes;
+#if SW_HAS_X86_SIMD
+        if (skinSimdEnabled()) { leafDistAvx(s, p, out); return; }
+#endif
+        for (int l = 0; l < kSegLanes; ++l) out[l] = distPointSegment(p, a[s + l], b[s + l]);
+    }
+
+#if SW_HAS_X86_SIMD
+    SW_TARGET_AVX void leafDistAvx(int s, const dvec3& p, double* out) const {
+        const __m256d zero = _mm256_setzero_pd(), one = _mm256_set1_pd(1.0);
+        const __m256d px = _mm256_set1_pd(p.x), py = _mm256_set1_pd(p.y), pz = _mm256_set1_pd(p.z);
+        const __m256d sax = _mm256_loadu_pd(&ax[s]), say = _mm256_loadu_pd(&ay[s]), saz = _mm256_loadu_pd(&az[s]);
+        const __m256d ex = _mm256_loadu_pd(&abx[s]), ey = _mm256_loadu_pd(&aby[s]), ez = _mm256_loadu_pd(&abz[s]);
+        const __m256d l2 = _mm256_loadu_pd(&len2[s]);
+        // t = clamp(dot(p - a, ab) / len2, 0, 1), or 0 for a degenerate segment.
+        const __m256d dx = _mm256_sub_pd(px, sax), dy = _mm256_sub_pd(py, say), dz = _mm256_sub_pd(pz, saz);
+        const __m256d num = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(dx, ex), _mm256_mul_pd(dy, ey)),
+                                          _mm256_mul_pd(dz, ez));
+        __m256d t = _mm256_div_pd(num, l2);
+        t = _mm256_min_pd(one, _mm256_max_pd(zero, t));        // operand order as std::min/max
+        t = _mm256_and_pd(t, _mm256_cmp_pd(l2, _mm256_set1_pd(1e-18), _CMP_GT_OQ));
+        // |p - (a + t ab)|
+        const __m256d qx = _mm256_sub_pd(px, _mm256_add_pd(sax, _mm256_mul_pd(t, ex)));
+        const __m256d qy = _mm256_sub_pd(py, _mm256_add_pd(say, _mm256_mul_pd(t, ey)));
+        const __m256d qz = _mm256_sub_pd(pz, _mm256_add_pd(saz, _mm256_mul_pd(t, ez)));
+        const __m256d d2 = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(qx, qx), _mm256_mul_pd(qy, qy)),
+                                         _mm256_mul_pd(qz, qz));
+        _mm256_storeu_pd(out, _mm256_sqrt_pd(d2));
+    }
+#endif
+
+    // Depth-first, nearer child first.  far(lb) says whether a subtree whose
+    // box is lb away can be skipped; visit(leaf) evaluates a leaf.
+    template <class Far, class Visit>
+    void traverse(const dvec3& p, Far&& far, Visit&& visit) const {
+        if (nodes.empty()) return;
+        int stack[64];
+        int sp = 0;
+        stack[sp++] = 0;
+        while (sp > 0) {
+            const Node& n = nodes[stack[--sp]];
+            if (far(boxDist(n, p))) continue;
+            if (n.leaf >= 0) { visit(n.leaf); continue; }
+            const double dl = boxDist(nodes[n.left], p), dr = boxDist(nodes[n.right], p);
+            if (dl <= dr) { stack[sp++] = n.right; stack[sp++] = n.left; }
+            else          { stack[sp++] = n.left;  stack[sp++] = n.right; }
+        }
+    }
+
+    // Index (and distance) of the nearest joint to p: the lowest joint index
+    // among those at the minimum distance, like a scan over all joints.
+    std::pair<int, double> nearest(const dvec3& p) const {
+        int best = 0;
+        double bd = kInf;
+        traverse(p, [&](double lb) { return lb > bd; }, [&](int leaf) {
+            double d[kSegLanes];
+            leafDist(leaf, p, d);
+            for (int l = 0; l < kSegLanes; ++l) {
+                const int j = joint[leaf * kSegLanes + l];
+                if (j >= 0 && (d[l] < bd || (d[l] == bd && j < best))) { bd = d[l]; best = j; }
+            }
+        });
+        return { best, bd };
+    }
+};
+
+// ---------------------------------------------------------------------------
+//  Compressed sparse row matrix.  Diagonal terms are kept separately by the
+//  owners (Ldiag etc.), so only off-diagonal entries live here; columns are
+//  sorted within each row.
+// ---------------------------------------------------------------------------
+struct CsrMatrix {
+    int n = 0;
+    std::vector<int>    row_ptr;   // n + 1 offsets into col / val
+    std::vector<int>    col;
+    std::vector<double> val;
+
+    int begin(int i) const { return row_ptr[i]; }
+    int end(int i)   const { return row_ptr[i + 1]; }
+};
 
 // ---------------------------------------------------------------------------
 //  Sparse mesh operators built once and shared by the solvers.
 //
 //   - graph      : undirected adjacency with Euclidean edge lengths (Dijkstra)
 //   - Loff/Ldiag : clamped cotangent Laplacian  L = D - W,  W >= 0
-//                  SpMV:  (L x)_i = Ldiag_i*x_i + sum_j Loff_ij.val * x_col
+//                  SpMV:  (L x)_i = Ldiag_i*x_i + sum_k Loff.val[k] * x[Loff.col[k]]
 //   - mass/minv  : lumped (barycentric) vertex areas and their inverse
 // ---------------------------------------------------------------------------
 struct MeshOps {
     int nv = 0;
-    std::vector<std::vector<std::pair<int, double>>> graph;
-    std::vector<std::vector<std::pair<int, double>>> Loff;   // (col, -w_ij)
+    CsrMatrix graph;                  // val = edge length
+    CsrMatrix Loff;                   // val = -w_ij  (only w_ij > 0 kept)
     std::vector<double> Ldiag;
     std::vector<double> mass, minv;
     double avg_edge = 0.0;
 };
 
-MeshOps buildMeshOps(const TriangleMesh& mesh) {
+// The graph, cotangent weights and lumped areas come straight from the shared
+// MeshTopology; only the clamping (w_ij >= 0, mass > 0) happens here.
+MeshOps buildMeshOps(const MeshTopology& topo) {
     MeshOps ops;
-    const int nv = static_cast<int>(mesh.positions.size());
+    const int nv = topo.num_welded;
+    const size_t nnz = topo.adj_col.size();
     ops.nv = nv;
-    ops.graph.assign(nv, {});
-    ops.mass.assign(nv, 0.0);
 
-    std::vector<std::unordered_map<int, double>> wmap(nv);   // accumulated cotan w_ij
-    std::vector<std::unordered_map<int, double>> gmap(nv);   // edge lengths (dedup)
+    ops.graph.n = ops.Loff.n = nv;
+    ops.graph.row_ptr = topo.adj_ptr;
+    ops.graph.col = topo.adj_col;
+    ops.graph.val = topo.adj_len;
+    ops.Loff.row_ptr.assign(nv + 1, 0);
+    ops.Loff.col.reserve(nnz);
+    ops.Loff.val.reserve(nnz);
+    ops.Ldiag.assign(nv, 0.0);
+    ops.mass.resize(nv);
+    ops.minv.resize(nv);
 
-    auto addEdge = [&](int i, int j) {
-        if (i == j) return;
-        if (gmap[i].find(j) == gmap[i].end()) {
-            double len = glm::length(dvec3(mesh.positions[i]) - dvec3(mesh.positions[j]));
-            gmap[i][j] = len;
-            gmap[j][i] = len;
+    double edge_sum = 0.0;
+    for (int i = 0; i < nv; ++i) {
+        for (int k = topo.begin(i); k < topo.end(i); ++k) {
+            edge_sum += topo.adj_len[k];
+            const double w = std::max(topo.adj_cot[k], 0.0);   // clamp -> M-matrix / stable
+            if (w <= 0.0) continue;
+            ops.Loff.col.push_back(topo.adj_col[k]);
+            ops.Loff.val.push_back(-w);
+            ops.Ldiag[i] += w;
         }
-    };
-    auto cotAt = [](const dvec3& v, const dvec3& a, const dvec3& b) {
-        dvec3 e0 = a - v, e1 = b - v;
-        double cr = glm::length(glm::cross(e0, e1));
-        if (cr < 1e-15) return 0.0;
-        return glm::dot(e0, e1) / cr;
-    };
+        ops.Loff.row_ptr[i + 1] = (int)ops.Loff.col.size();
+        ops.mass[i] = std::max(topo.mass[i], 1e-12);
+        ops.minv[i] = 1.0 / ops.mass[i];
+    }
+    ops.avg_edge = (nnz ? edge_sum / double(nnz) : 1.0);
+    return ops;
+}
+
+// ---------------------------------------------------------------------------
+//  Fill-reducing ordering: geometric nested dissection.
+//
+//  The vertex set is split at the median along its longest bounding-box
+//  axis; left vertices with a neighbour on the right form the separator.
+//  Both halves are ordered recursively and the separator is eliminated last,
+//  which keeps the Cholesky fill of a surface mesh near O(n log n).
+//  perm[k] = original index of the k-th pivot.
+// ---------------------------------------------------------------------------
+constexpr int kNdLeafSize = 32;
 
-    const auto& idx = mesh.indices;
-    for (size_t t = 0; t + 2 < idx.size(); t += 3) {
-        int a = idx[t], b = idx[t + 1], c = idx[t + 2];
-        if (a < 0 || b < 0 || c < 0 || a >= nv || b >= nv || c >= nv) continue;
-        dvec3 pa(mesh.positions[a]), pb(mesh.positions[b]), pc(mesh.positions[c]);
+void ndRecurse(const CsrMatrix& adj, const std::vector<glm::vec3>& pts,
+               int* ids, int n, std::vector<uint8_t>& side, std::vector<int>& perm) {
+    if (n <= kNdLeafSize) { perm.insert(perm.end(), ids, ids + n); return; }
 
-        double area = 0.5 * glm::length(glm::cross(pb - pa, pc - pa));
-        double third = area / 3.0;
-        ops.mass[a] += third; ops.mass[b] += third; ops.mass[c] += third;
+    glm::vec3 lo(pts[ids[0]]), hi(pts[ids[0]]);
+    for (int i = 1; i < n; ++i) { lo = glm::min(lo, pts[ids[i]]); hi = glm::max(hi, pts[ids[i]]); }
+    const glm::vec3 ext = hi - lo;
+    const int axis = (ext.x >= ext.y && ext.x >= ext.z) ? 0 : (ext.y >= ext.z ? 1 : 2);
 
-        // cotan(angle at X) weights the OPPOSITE edge.
-        double cA = cotAt(pa, pb, pc);   // -> edge (b,c)
-        double cB = cotAt(pb, pc, pa);   // -> edge (c,a)
-        double cC = cotAt(pc, pa, pb);   // -> edge (a,b)
-        wmap[b][c] += 0.5 * cA; wmap[c][b] += 0.5 * cA;
-        wmap[c][a] += 0.5 * cB; wmap[a][c] += 0.5 * cB;
-        wmap[a][b] += 0.5 * cC; wmap[b][a] += 0.5 * cC;
+    const int half = n / 2;
+    std::nth_element(ids, ids + half, ids + n, [&](int a, int b) {
+        float pa = pts[a][axis], pb = pts[b][axis];
+        return pa < pb || (pa == pb && a < b);
+    });
+    for (int i = 0; i < n; ++i) side[ids[i]] = (i < half) ? 1 : 2;
 
-        addEdge(a, b); addEdge(b, c); addEdge(c, a);
+    std::vector<int> sep;
+    int nl = 0;
+    for (int i = 0; i < half; ++i) {
+        const int v = ids[i];
+        bool cut = false;
+        for (int k = adj.begin(v); k < adj.end(v) && !cut; ++k) cut = (side[adj.col[k]] == 2);
+        if (cut) sep.push_back(v); else ids[nl++] = v;
     }
+    for (int i = 0; i < n; ++i) side[ids[i]] = 0;
+    for (int v : sep) side[v] = 0;
 
-    ops.Loff.assign(nv, {});
-    ops.Ldiag.assign(nv, 0.0);
-    ops.minv.assign(nv, 0.0);
-    double edge_sum = 0.0; size_t edge_cnt = 0;
-    for (int i = 0; i < nv; ++i) {
-        double diag = 0.0;
-        for (auto& kv : wmap[i]) {
-            double w = std::max(kv.second, 0.0);   // clamp -> M-matrix / stable
-            if (w <= 0.0) continue;
-            ops.Loff[i].push_back({kv.first, -w});
-            diag += w;
+    ndRecurse(adj, pts, ids, nl, side, perm);
+    ndRecurse(adj, pts, ids + half, n - half, side, perm);
+    perm.insert(perm.end(), sep.begin(), sep.end());
+}
+
+std::vector<int> nestedDissectionOrder(const CsrMatrix& adj, const std::vector<glm::vec3>& pts) {
+    const int n = adj.n;
+    std::vector<int> ids(n), perm;
+    for (int i = 0; i < n; ++i) ids[i] = i;
+    perm.reserve(n);
+    std::vector<uint8_t> side(n, 0);
+    ndRecurse(adj, pts, ids.data(), n, side, perm);
+    return perm;
+}
+
+// ---------------------------------------------------------------------------
+//  Sparse LDL^T factorisation (up-looking, elimination-tree based) of a
+//  symmetric matrix given as diag + off-diagonal CSR (full pattern) under a
+//  symmetric permutation.  Factored once per solver, then every joint's
+//  right-hand side costs two triangular solves.
+// ---------------------------------------------------------------------------
+struct LdltFactor {
+    int n = 0;
+    std::vector<int>    perm, pinv;       // pivot k <-> original row perm[k]
+    std::vector<int>    Lp, Li;           // unit lower L, CSC, diagonal implied
+    std::vector<double> Lx, D;
+};
+
+// Budget for nnz(L): ~12 bytes per entry, so this caps the factor at a few
+// hundred MB.  Larger systems use the iterative solver instead.
+constexpr size_t kMaxFactorNnz = size_t(24) << 20;
+
+// Returns false (leaving `f` unusable) if the predicted fill exceeds
+// `max_nnz` or a pivot is not safely positive (singular / indefinite).
+bool factorLdlt(const CsrMatrix& off, const std::vector<double>& diag,
+                std::vector<int> perm, size_t max_nnz, LdltFactor& f) {
+    const int n = off.n;
+    f.n = n;
+    f.perm = std::move(perm);
+    f.pinv.assign(n, 0);
+    for (int k = 0; k < n; ++k) f.pinv[f.perm[k]] = k;
+
+    // Symbolic: elimination tree and column counts of L.
+    std::vector<int> parent(n), lnz(n, 0), flag(n);
+    for (int k = 0; k < n; ++k) {
+        parent[k] = -1; flag[k] = k;
+        const int kk = f.perm[k];
+        for (int p = off.begin(kk); p < off.end(kk); ++p) {
+            int i = f.pinv[off.col[p]];
+            if (i >= k) continue;
+            for (; flag[i] != k; i = parent[i]) {
+                if (parent[i] == -1) parent[i] = k;
+                ++lnz[i];
+                flag[i] = k;
+            }
         }
-        ops.Ldiag[i] = diag;
-        ops.mass[i] = std::max(ops.mass[i], 1e-12);
-        ops.minv[i] = 1.0 / ops.mass[i];
-        for (auto& kv : gmap[i]) { ops.graph[i].push_back(kv); edge_sum += kv.second; ++edge_cnt; }
     }
-    ops.avg_edge = (edge_cnt ? edge_sum / double(edge_cnt) : 1.0);
-    return ops;
-}
+    f.Lp.assign(n + 1, 0);
+    for (int k = 0; k < n; ++k) f.Lp[k + 1] = f.Lp[k] + lnz[k];
+    if (size_t(f.Lp[n]) > max_nnz) return false;
 
-inline void applyL(const MeshOps& ops, const std::vector<double>& x, std::vector<double>& y) {
-    for (int i = 0; i < ops.nv; ++i) {
-        double s = ops.Ldiag[i] * x[i];
-        for (auto& e : ops.Loff[i]) s += e.second * x[e.first];
-        y[i] = s;
+    // Numeric: row k of L from a sparse triangular solve along the etree.
+    f.Li.resize(f.Lp[n]);
+    f.Lx.resize(f.Lp[n]);
+    f.D.assign(n, 0.0);
+    std::vector<double> y(n, 0.0);
+    std::vector<int> pattern(n);
+    std::fill(lnz.begin(), lnz.end(), 0);
+    for (int k = 0; k < n; ++k) {
+        const int kk = f.perm[k];
+        int top = n;
+        flag[k] = k;
+        y[k] = diag[kk];
+        for (int p = off.begin(kk); p < off.end(kk); ++p) {
+            int i = f.pinv[off.col[p]];
+            if (i >= k) continue;
+            y[i] += off.val[p];
+            int len = 0;
+            for (; flag[i] != k; i = parent[i]) { pattern[len++] = i; flag[i] = k; }
+            while (len > 0) pattern[--top] = pattern[--len];
+        }
+        double dk = y[k];
+        y[k] = 0.0;
+        for (; top < n; ++top) {
+            const int i = pattern[top];
+            const double yi = y[i];
+            y[i] = 0.0;
+            int p = f.Lp[i];
+            const int p2 = p + lnz[i];
+            for (; p < p2; ++p) y[f.Li[p]] -= f.Lx[p] * yi;
+            const double lki = yi / f.D[i];
+            dk -= lki * yi;
+            f.Li[p] = k;
+            f.Lx[p] = lki;
+            ++lnz[i];
+        }
+        if (!(dk > 1e-12 * std::abs(diag[kk]))) return false;
+        f.D[k] = dk;
     }
+    return true;
+}
+
+// x <- A^-1 x  (x in original ordering).  z: scratch of f.n entries.
+void solveLdlt(const LdltFactor& f, std::vector<double>& x, std::vector<double>& z) {
+    const int n = f.n;
+    for (int k = 0; k < n; ++k) z[k] = x[f.perm[k]];
+    for (int j = 0; j < n; ++j)
+        for (int p = f.Lp[j]; p < f.Lp[j + 1]; ++p) z[f.Li[p]] -= f.Lx[p] * z[j];
+    for (int j = 0; j < n; ++j) z[j] /= f.D[j];
+    for (int j = n - 1; j >= 0; --j)
+        for (int p = f.Lp[j]; p < f.Lp[j + 1]; ++p) z[j] -= f.Lx[p] * z[f.Li[p]];
+    for (int k = 0; k < n; ++k) x[f.perm[k]] = z[k];
 }
 
 // ---------------------------------------------------------------------------
-//  Conjugate gradient for SPD systems, Jacobi-preconditioned.
-//  matvec(x,y): y = A x.   diag: A's diagonal (for the preconditioner).
-//  Returns false if the result is non-finite.
+//  Blocked preconditioned conjugate gradient for SPD systems.
+//
+//  Solves A X = B for `nb` right-hand sides at once.  Blocks are stored
+//  row-interleaved (entry (i, c) at [i*nb + c]) so one block mat-vec streams
+//  the matrix a single time for every column.  Each column keeps its own
+//  alpha/beta and stops on its own residual, doing exactly the arithmetic of
+//  a one-column solve: results do not depend on how columns are grouped.
+//  Finished columns are packed out of the working block, so slow columns
+//  don't drag converged ones through further mat-vecs.
+//  matvec(X,Y,w): Y = A X and precond(R,Z,w): Z = M^-1 R for a w-column
+//  block (see JacobiPrecond).  iters, if given, receives each column's
+//  iteration count.  Returns false if the result is non-finite.
 // ---------------------------------------------------------------------------
-template <class MatVec>
-bool cg(MatVec&& matvec, const std::vector<double>& diag, const std::vector<double>& b,
-        std::vector<double>& x, int max_iter, double tol) {
-    const int n = (int)b.size();
-    std::vector<double> r(n), z(n), p(n), Ap(n);
-    matvec(x, Ap);
-    for (int i = 0; i < n; ++i) r[i] = b[i] - Ap[i];
-    auto precond = [&](const std::vector<double>& in, std::vector<double>& out) {
-        for (int i = 0; i < n; ++i) out[i] = (diag[i] > 1e-30) ? in[i] / diag[i] : in[i];
+constexpr int kCgBlockCols = 8;
+
+template <class BlockMatVec, class BlockPrecond>
+bool cgBlock(BlockMatVec&& matvec, BlockPrecond&& precondition, int n, int nb,
+             const std::vector<double>& b, std::vector<double>& x, int max_iter, double tol,
+             int* iters = nullptr) {
+    const size_t len = size_t(n) * nb;
+    int w = nb;                                   // live columns in the working block
+    std::vector<int> slot(nb);                    // working column -> caller column
+    for (int c = 0; c < nb; ++c) slot[c] = c;
+    std::vector<double> xw = x, r(len), z(len), p(len), Ap(len);
+    std::vector<double> rz(nb, 0.0), bnorm(nb, 0.0), pAp(nb), rnorm2(nb), coef(nb);
+    std::vector<char> live(nb, 1);
+    std::vector<int> keep;
+    keep.reserve(nb);
+    int it = 0;
+
+    auto precond = [&]() { precondition(r, z, w); };
+    // Write finished columns back to x and squeeze them out of xw / r / p
+    // (in place: a destination never passes an unread source).
+    auto retire = [&]() {
+        keep.clear();
+        for (int c = 0; c < w; ++c) {
+            if (live[c]) { keep.push_back(c); continue; }
+            for (int i = 0; i < n; ++i) x[size_t(i) * nb + slot[c]] = xw[size_t(i) * w + c];
+            if (iters) iters[slot[c]] = it;
+        }
+        const int nw = (int)keep.size();
+        for (std::vector<double>* v : { &xw, &r, &p })
+            for (int i = 0; i < n; ++i)
+                for (int t = 0; t < nw; ++t) (*v)[size_t(i) * nw + t] = (*v)[size_t(i) * w + keep[t]];
+        for (int t = 0; t < nw; ++t) {
+            slot[t] = slot[keep[t]]; rz[t] = rz[keep[t]]; bnorm[t] = bnorm[keep[t]]; live[t] = 1;
+        }
+        w = nw;
     };
-    precond(r, z);
+
+    matvec(xw, Ap, w);
+    for (size_t k = 0; k < len; ++k) r[k] = b[k] - Ap[k];
+    precond();
     p = z;
-    double rz = 0.0; for (int i = 0; i < n; ++i) rz += r[i] * z[i];
-    double bnorm = 0.0; for (int i = 0; i < n; ++i) bnorm += b[i] * b[i];
-    bnorm = std::sqrt(bnorm) + 1e-30;
-
-    for (int it = 0; it < max_iter; ++it) {
-        matvec(p, Ap);
-        double pAp = 0.0; for (int i = 0; i < n; ++i) pAp += p[i] * Ap[i];
-        if (std::abs(pAp) < 1e-300) break;
-        double alpha = rz / pAp;
-        double rnorm2 = 0.0;
-        for (int i = 0; i < n; ++i) { x[i] += alpha * p[i]; r[i] -= alpha * Ap[i]; rnorm2 += r[i] * r[i]; }
-        if (std::sqrt(rnorm2) / bnorm < tol) break;
-        precond(r, z);
-        double rz_new = 0.0; for (int i = 0; i < n; ++i) rz_new += r[i] * z[i];
-        double beta = rz_new / (rz + 1e-300);
-        for (int i = 0; i < n; ++i) p[i] = z[i] + beta * p[i];
-        rz = rz_new;
+    for (size_t k0 = 0; k0 < len; k0 += nb)
+        for (int c = 0; c < nb; ++c) { rz[c] += r[k0 + c] * z[k0 + c]; bnorm[c] += b[k0 + c] * b[k0 + c]; }
+    for (int c = 0; c < nb; ++c) bnorm[c] = std::sqrt(bnorm[c]) + 1e-30;
+
+    for (; it < max_iter && w > 0;) {
+        ++it;
+        const size_t wl = size_t(n) * w;
+        matvec(p, Ap, w);
+        std::fill(pAp.begin(), pAp.begin() + w, 0.0);
+        for (size_t k0 = 0; k0 < wl; k0 += w)
+            for (int c = 0; c < w; ++c) pAp[c] += p[k0 + c] * Ap[k0 + c];
+        bool retired = false;
+        for (int c = 0; c < w; ++c) {
+            if (std::abs(pAp[c]) < 1e-300) { live[c] = 0; retired = true; }
+            coef[c] = live[c] ? rz[c] / pAp[c] : 0.0;               // alpha
+        }
+        std::fill(rnorm2.begin(), rnorm2.begin() + w, 0.0);
+        for (size_t k0 = 0; k0 < wl; k0 += w) {
+            for (int c = 0; c < w; ++c) {
+                if (!live[c]) continue;
+                const size_t k = k0 + c;
+                xw[k] += coef[c] * p[k]; r[k] -= coef[c] * Ap[k]; rnorm2[c] += r[k] * r[k];
+            }
+        }
+        for (int c = 0; c < w; ++c)
+            if (live[c] && std::sqrt(rnorm2[c]) / bnorm[c] < tol) { live[c] = 0; retired = true; }
+        if (retired) retire();
+        if (w == 0) break;
+
+        const size_t nl = size_t(n) * w;
+        precond();
+        std::fill(coef.begin(), coef.begin() + w, 0.0);             // rz_new
+        for (size_t k0 = 0; k0 < nl; k0 += w)
+            for (int c = 0; c < w; ++c) coef[c] += r[k0 + c] * z[k0 + c];
+        for (int c = 0; c < w; ++c) std::swap(rz[c], coef[c]);     // coef = old rz
+        for (size_t k0 = 0; k0 < nl; k0 += w)
+            for (int c = 0; c < w; ++c) p[k0 + c] = z[k0 + c] + rz[c] / (coef[c] + 1e-300) * p[k0 + c];
     }
+    for (int c = 0; c < w; ++c) live[c] = 0;
+    retire();
     for (double v : x) if (!std::isfinite(v)) return false;
     return true;
 }
 
+// Y = (diag + Off) X  for an nb-column row-interleaved block.
+inline void spmvBlock(const CsrMatrix& off, const std::vector<double>& diag, int nb,
+                      const std::vector<double>& x, std::vector<double>& y) {
+    for (int i = 0; i < off.n; ++i) {
+        double*       yi = &y[size_t(i) * nb];
+        const double* xi = &x[size_t(i) * nb];
+        for (int c = 0; c < nb; ++c) yi[c] = diag[i] * xi[c];
+        for (int k = off.begin(i); k < off.end(i); ++k) {
+            const double  a  = off.val[k];
+            const double* xj = &x[size_t(off.col[k]) * nb];
+            for (int c = 0; c < nb; ++c) yi[c] += a * xj[c];
+        }
+    }
+}
+
+// Z = D^-1 R: the Jacobi preconditioner for cgBlock.
+struct JacobiPrecond {
+    const std::vector<double>& diag;
+
+    void operator()(const std::vector<double>& r, std::vector<double>& z, int w) const {
+        for (size_t i = 0; i < diag.size(); ++i) {
+            const double d = diag[i];
+            for (int c = 0; c < w; ++c) {
+                const size_t k = i * w + c;
+                z[k] = (d > 1e-30) ? r[k] / d : r[k];
+            }
+        }
+    }
+};
+
+// Y = A X for a general (e.g. rectangular transfer) CSR matrix whose val
+// holds every entry; w-column row-interleaved blocks.
+inline void mulBlock(const CsrMatrix& a, int w, const std::vector<double>& x, std::vector<double>& y) {
+    for (int i = 0; i < a.n; ++i) {
+        double* yi = &y[size_t(i) * w];
+        std::fill(yi, yi + w, 0.0);
+        for (int k = a.begin(i); k < a.end(i); ++k) {
+            const double  v  = a.val[k];
+            const double* xj = &x[size_t(a.col[k]) * w];
+            for (int c = 0; c < w; ++c) yi[c] += v * xj[c];
+        }
+    }
+}
+
 // ---------------------------------------------------------------------------
-//  Dense per-joint weight matrix -> pruned/normalised SkinWeights.
-//  Picks the top `k` joints per vertex and renormalises to a partition of 1.
+//  Smoothed-aggregation AMG, used as a CG preconditioner (one symmetric
+//  V-cycle per application).  Jacobi-preconditioned CG needs more iterations
+//  every time the mesh is refined; with the multigrid hierarchy the count
+//  stays roughly flat.
+//
+//   - aggregates : greedy, over strong couplings |a_ij| > theta*sqrt(a_ii a_jj)
+//   - prolongator: constant per aggregate, smoothed once by damped Jacobi
+//   - coarse ops : Galerkin P^T A P, down to kAmgCoarseSize rows, which are
+//                  solved exactly with the sparse LDL^T
+//   - smoother   : kAmgSweeps damped-Jacobi sweeps before and after the
+//                  coarse correction (symmetric, so valid inside CG)
 // ---------------------------------------------------------------------------
-SkinWeights finalize(const std::vector<std::vector<double>>& W /*[nj][nv]*/,
-                     int nv, int nj, int k,
-                     const std::vector<int>& nearest /*fallback owner per vertex*/) {
-    k = glm::clamp(k, 1, kMaxVertexInfluences);
-    SkinWeights out;
-    out.per_vertex.resize(nv);
-    for (int v = 0; v < nv; ++v) {
-        std::vector<std::pair<double, int>> col;
-        col.reserve(nj);
-        for (int j = 0; j < nj; ++j) {
-            double w = W[j][v];
-            if (std::isfinite(w) && w > 1e-7) col.push_back({w, j});
-        }
-        std::sort(col.begin(), col.end(), [](auto& a, auto& b) { return a.first > b.first; });
-        auto& vsd = out.per_vertex[v];
-        double sum = 0.0;
-        int n = std::min((int)col.size(), k);
-        for (int i = 0; i < n; ++i) { vsd.joint_indices[i] = col[i].second; vsd.weights[i] = (float)col[i].first; sum += col[i].first; }
-        if (sum > 1e-12) {
-            for (int i = 0; i < kMaxVertexInfluences; ++i) vsd.weights[i] /= (float)sum;
-        } else {
-            // Degenerate: hard-bind to nearest joint.
-            vsd.joint_indices[0] = (v < (int)nearest.size()) ? nearest[v] : 0;
-            vsd.weights[0] = 1.0f;
-            for (int i = 1; i < kMaxVertexInfluences; ++i) { vsd.joint_indices[i] = 0; vsd.weights[i] = 0.0f; }
+constexpr int    kAmgCoarseSize = 256;
+constexpr int    kAmgMaxLevels  = 16;
+constexpr int    kAmgSweeps     = 2;
+constexpr double kAmgStrength   = 0.08;
+
+struct AmgLevel {
+    CsrMatrix           off;          // operator on this level (off-diagonal)
+    std::vector<double> diag;
+    double              omega = 0.0;  // damped-Jacobi weight 4 / (3 rho(D^-1 A))
+    CsrMatrix           P, R;         // to / from the next coarser level (R = P^T)
+};
+
+struct AmgHierarchy {
+    std::vector<AmgLevel> levels;     // [0] = fine operator
+    LdltFactor            coarse;     // exact solve on levels.back()
+};
+
+// 4 / (3 rho) with rho(D^-1 A) bounded by Gershgorin (cheap and never low).
+double jacobiOmega(const CsrMatrix& off, const std::vector<double>& diag) {
+    double rho = 1.0;
+    for (int i = 0; i < off.n; ++i) {
+        double s = std::abs(diag[i]);
+        for (int k = off.begin(i); k < off.end(i); ++k) s += std::abs(off.val[k]);
+        if (diag[i] > 0.0) rho = std::max(rho, s / diag[i]);
+    }
+    return 4.0 / (3.0 * rho);
+}
+
+// agg[i] = aggregate of row i.  Returns the number of aggregates.
+int aggregate(const CsrMatrix& off, const std::vector<double>& diag, std::vector<int>& agg) {
+    const int n = off.n;
+    auto strong = [&](int i, int k) {
+        return std::abs(off.val[k]) > kAmgStrength * std::sqrt(std::abs(diag[i] * diag[off.col[k]]));
+    };
+    agg.assign(n, -1);
+    int na = 0;
+    // 1) Roots whose whole strong neighbourhood is still unaggregated.
+    for (int i = 0; i < n; ++i) {
+        if (agg[i] >= 0) continue;
+        bool free = true;
+        for (int k = off.begin(i); k < off.end(i) && free; ++k)
+            if (strong(i, k) && agg[off.col[k]] >= 0) free = false;
+        if (!free) continue;
+        agg[i] = na;
+        for (int k = off.begin(i); k < off.end(i); ++k) if (strong(i, k)) agg[off.col[k]] = na;
+        ++na;
+    }
+    // 2) Leftovers join the aggregate of their strongest aggregated neighbour.
+    const std::vector<int> roots = agg;
+    for (int i = 0; i < n; ++i) {
+        if (agg[i] >= 0) continue;
+        double best = 0.0;
+        for (int k = off.begin(i); k < off.end(i); ++k) {
+            const int a = roots[off.col[k]];
+            if (a >= 0 && strong(i, k) && std::abs(off.val[k]) > best) { best = std::abs(off.val[k]); agg[i] = a; }
+        }
+    }
+    // 3) Whatever is left forms new aggregates with its free neighbours.
+    for (int i = 0; i < n; ++i) {
+        if (agg[i] >= 0) continue;
+        agg[i] = na;
+        for (int k = off.begin(i); k < off.end(i); ++k)
+            if (strong(i, k) && agg[off.col[k]] < 0) agg[off.col[k]] = na;
+        ++na;
+    }
+    return na;
+}
+
+// C = (diag(adiag) + A) B  (adiag may be null).  B and C hold every entry.
+CsrMatrix spgemm(const CsrMatrix& a, const std::vector<double>* adiag, const CsrMatrix& b, int bcols) {
+    CsrMatrix c;
+    c.n = a.n;
+    c.row_ptr.assign(a.n + 1, 0);
+    std::vector<double> acc(bcols, 0.0);
+    std::vector<uint8_t> mark(bcols, 0);
+    std::vector<int> touched;
+    auto addRow = [&](int r, double s) {
+        for (int q = b.begin(r); q < b.end(r); ++q) {
+            const int j = b.col[q];
+            if (!mark[j]) { mark[j] = 1; touched.push_back(j); }
+            acc[j] += s * b.val[q];
+        }
+    };
+    for (int i = 0; i < a.n; ++i) {
+        if (adiag) addRow(i, (*adiag)[i]);
+        for (int k = a.begin(i); k < a.end(i); ++k) addRow(a.col[k], a.val[k]);
+        std::sort(touched.begin(), touched.end());
+        for (int j : touched) { c.col.push_back(j); c.val.push_back(acc[j]); acc[j] = 0.0; mark[j] = 0; }
+        touched.clear();
+        c.row_ptr[i + 1] = (int)c.col.size();
+    }
+    return c;
+}
+
+CsrMatrix transpose(const CsrMatrix& a, int ncols) {
+    CsrMatrix t;
+    t.n = ncols;
+    t.row_ptr.assign(ncols + 1, 0);
+    for (int j : a.col) ++t.row_ptr[j + 1];
+    for (int j = 0; j < ncols; ++j) t.row_ptr[j + 1] += t.row_ptr[j];
+    t.col.resize(a.col.size());
+    t.val.resize(a.val.size());
+    std::vector<int> next(t.row_ptr.begin(), t.row_ptr.end() - 1);
+    for (int i = 0; i < a.n; ++i)
+        for (int k = a.begin(i); k < a.end(i); ++k) {
+            const int q = next[a.col[k]]++;
+            t.col[q] = i;
+            t.val[q] = a.val[k];
+        }
+    return t;
+}
+
+// P = (I - omega D^-1 A) P0, P0 = per-aggregate constant scaled to unit norm.
+CsrMatrix smoothedProlongator(const AmgLevel& lv, const std::vector<int>& agg, int na) {
+    const int n = lv.off.n;
+    std::vector<int> size(na, 0);
+    for (int a : agg) ++size[a];
+    std::vector<double> p0(n);
+    for (int i = 0; i < n; ++i) p0[i] = 1.0 / std::sqrt(double(size[agg[i]]));
+
+    CsrMatrix P;
+    P.n = n;
+    P.row_ptr.assign(n + 1, 0);
+    std::vector<double> acc(na, 0.0);
+    std::vector<uint8_t> mark(na, 0);
+    std::vector<int> touched;
+    auto add = [&](int a, double v) {
+        if (!mark[a]) { mark[a] = 1; touched.push_back(a); }
+        acc[a] += v;
+    };
+    for (int i = 0; i < n; ++i) {
+        const double s = lv.omega / lv.diag[i];
+        add(agg[i], (1.0 - lv.omega) * p0[i]);
+        for (int k = lv.off.begin(i); k < lv.off.end(i); ++k) {
+            const int j = lv.off.col[k];
+            add(agg[j], -s * lv.off.val[k] * p0[j]);
         }
+        std::sort(touched.begin(), touched.end());
+        for (int a : touched) { P.col.push_back(a); P.val.push_back(acc[a]); acc[a] = 0.0; mark[a] = 0; }
+        touched.clear();
+        P.row_ptr[i + 1] = (int)P.col.size();
     }
-    return out;
+    return P;
 }
 
-// A few Laplacian smoothing passes on the dense weights (then renormalised
-// in finalize()).  Cheap way to remove boundary speckle for geodesic.
-void smoothWeights(const MeshOps& ops, std::vector<std::vector<double>>& W, int nj, int passes) {
+// Returns false if the hierarchy can't be built (e.g. singular coarse
+// operator); callers then stay with Jacobi.
+bool buildAmg(const CsrMatrix& off, const std::vector<double>& diag, AmgHierarchy& h) {
+    for (double d : diag) if (!(d > 0.0)) return false;
+    h.levels.clear();
+    h.levels.push_back({ off, diag });
+    while (h.levels.back().off.n > kAmgCoarseSize && (int)h.levels.size() < kAmgMaxLevels) {
+        AmgLevel& fine = h.levels.back();
+        fine.omega = jacobiOmega(fine.off, fine.diag);
+        std::vector<int> agg;
+        const int na = aggregate(fine.off, fine.diag, agg);
+        if (na * 5 > fine.off.n * 4) break;                     // coarsening stalled
+        fine.P = smoothedProlongator(fine, agg, na);
+        fine.R = transpose(fine.P, na);
+        CsrMatrix rap = spgemm(fine.R, nullptr, spgemm(fine.off, &fine.diag, fine.P, na), na);
+
+        AmgLevel coarse;
+        coarse.off.n = na;
+        coarse.off.row_ptr.assign(na + 1, 0);
+        coarse.diag.assign(na, 0.0);
+        for (int i = 0; i < na; ++i) {
+            for (int k = rap.begin(i); k < rap.end(i); ++k) {
+                if (rap.col[k] == i) { coarse.diag[i] = rap.val[k]; continue; }
+                coarse.off.col.push_back(rap.col[k]);
+                coarse.off.val.push_back(rap.val[k]);
+            }
+            coarse.off.row_ptr[i + 1] = (int)coarse.off.col.size();
+        }
+        h.levels.push_back(std::move(coarse));
+    }
+    AmgLevel& last = h.levels.back();
+    last.omega = jacobiOmega(last.off, last.diag);
+    last.P = last.R = CsrMatrix{};
+    std::vector<int> perm(last.off.n);
+    for (int i = 0; i < last.off.n; ++i) perm[i] = i;
+    return factorLdlt(last.off, last.diag, std::move(perm), kMaxFactorNnz, h.coarse);
+}
+
+// One V-cycle, Z = M^-1 R, as a cgBlock preconditioner.  Per-level buffers
+// are sized for `nb` columns once and reused for every application.
+struct AmgPrecond {
+    const AmgHierarchy& h;
+    mutable std::vector<std::vector<double>> x, b, r;
+    mutable std::vector<double> col, work;           // coarse solve, one column
+
+    AmgPrecond(const AmgHierarchy& hier, int nb) : h(hier) {
+        if (nb <= 0) return;
+        for (size_t l = 0; l < h.levels.size(); ++l) {
+            // Level 0 reads the caller's R and writes Z directly.
+            const size_t len = size_t(h.levels[l].off.n) * nb;
+            x.emplace_back(l > 0 ? len : 0);
+            b.emplace_back(l > 0 ? len : 0);
+            r.emplace_back(len);
+        }
+        col.resize(h.coarse.n);
+        work.resize(h.coarse.n);
+    }
+
+    void operator()(const std::vector<double>& rhs, std::vector<double>& z, int w) const {
+        cycle(0, rhs, z, w);
+    }
+
+    void cycle(size_t l, const std::vector<double>& bl, std::vector<double>& xl, int w) const {
+        const AmgLevel& lv = h.levels[l];
+        const int n = lv.off.n;
+        if (l + 1 == h.levels.size()) {                          // exact coarse solve
+            for (int c = 0; c < w; ++c) {
+                for (int i = 0; i < n; ++i) col[i] = bl[size_t(i) * w + c];
+                solveLdlt(h.coarse, col, work);
+                for (int i = 0; i < n; ++i) xl[size_t(i) * w + c] = col[i];
+            }
+            return;
+        }
+        std::vector<double>& rl = r[l];
+        auto sweep = [&]() {                                     // x += omega D^-1 (b - A x)
+            spmvBlock(lv.off, lv.diag, w, xl, rl);
+            for (int i = 0; i < n; ++i) {
+                const double s = lv.omega / lv.diag[i];
+                for (int c = 0; c < w; ++c) {
+                    const size_t k = size_t(i) * w + c;
+                    xl[k] += s * (bl[k] - rl[k]);
+                }
+            }
+        };
+        for (int i = 0; i < n; ++i) {                            // first sweep from x = 0
+            const double s = lv.omega / lv.diag[i];
+            for (int c = 0; c < w; ++c) xl[size_t(i) * w + c] = s * bl[size_t(i) * w + c];
+        }
+        for (int s = 1; s < kAmgSweeps; ++s) sweep();
+
+        spmvBlock(lv.off, lv.diag, w, xl, rl);
+        for (size_t k = 0; k < size_t(n) * w; ++k) rl[k] = bl[k] - rl[k];
+        mulBlock(lv.R, w, rl, b[l + 1]);
+        cycle(l + 1, b[l + 1], x[l + 1], w);
+        mulBlock(lv.P, w, x[l + 1], rl);
+        for (size_t k = 0; k < size_t(n) * w; ++k) xl[k] += rl[k];
+
+        for (int s = 0; s < kAmgSweeps; ++s) sweep();
+    }
+};
+
+// Y = Q X with Q = L M^-1 L, for a w-column row-interleaved block.  Two
+// sweeps over L instead of separate mask / multiply / scale / multiply /
+// mask passes: the mass scaling is folded into the first, and with `anchor`
+// constrained dofs read as zero on input and are zeroed on output (the
+// free-free block Q_ff).  t: caller workspace of >= nv*w entries.
+void applyQBlock(const MeshOps& ops, const std::vector<int>* anchor, int w,
+                 const std::vector<double>& x, std::vector<double>& t, std::vector<double>& y) {
+    const CsrMatrix& L = ops.Loff;
+    auto isFree = [&](int v) { return !anchor || (*anchor)[v] < 0; };
+    for (int i = 0; i < ops.nv; ++i) {
+        double*       ti = &t[size_t(i) * w];
+        const double* xi = &x[size_t(i) * w];
+        const double  d  = isFree(i) ? ops.Ldiag[i] : 0.0;
+        for (int c = 0; c < w; ++c) ti[c] = d * xi[c];
+        for (int k = L.begin(i); k < L.end(i); ++k) {
+            const int j = L.col[k];
+            if (!isFree(j)) continue;
+            const double  a  = L.val[k];
+            const double* xj = &x[size_t(j) * w];
+            for (int c = 0; c < w; ++c) ti[c] += a * xj[c];
+        }
+        const double m = ops.minv[i];
+        for (int c = 0; c < w; ++c) ti[c] *= m;
+    }
+    for (int i = 0; i < ops.nv; ++i) {
+        double* yi = &y[size_t(i) * w];
+        if (!isFree(i)) { std::fill(yi, yi + w, 0.0); continue; }
+        const double* ti = &t[size_t(i) * w];
+        const double  d  = ops.Ldiag[i];
+        for (int c = 0; c < w; ++c) yi[c] = d * ti[c];
+        for (int k = L.begin(i); k < L.end(i); ++k) {
+            const double  a  = L.val[k];
+            const double* tj = &t[size_t(L.col[k]) * w];
+            for (int c = 0; c < w; ++c) yi[c] += a * tj[c];
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+//  Streaming per-vertex top-k -> pruned/normalised SkinWeights.
+//  Solvers hand over each joint's weight column as soon as it is solved;
+//  only the best `k` (weight, joint) pairs per vertex are kept, in float,
+//  directly in the output VertexSkinData.  No [nj][nv] matrix is ever built,
+//  so memory stays O(nv * k) however many joints the rig has.
+//  Slots are kept ordered by weight (ties: lower joint first), so the result
+//  doesn't depend on the order (or thread) columns arrive in.
+//  Vertices are guarded in stripes of kStripeVerts, each with its own lock,
+//  and every column starts at a different stripe, so concurrent solves merge
+//  side by side instead of queueing on one lock for a whole O(nv) pass.
+// ---------------------------------------------------------------------------
+struct TopKWeights {
+    static constexpr int kStripeVerts = 4096;
+
+    int k;
+    SkinWeights out;
+    std::vector<uint8_t> count;                   // filled slots per vertex
+    std::vector<std::mutex> stripe_mutex;         // one per kStripeVerts vertices
+
+    TopKWeights(int nv, int max_influences)
+        : k(glm::clamp(max_influences, 1, kMaxVertexInfluences)), count(nv, 0),
+          stripe_mutex(std::max(1, (nv + kStripeVerts - 1) / kStripeVerts)) {
+        out.per_vertex.resize(nv);
+    }
+
+    // Offer weight(v) of joint j for every vertex.  Safe to call from
+    // concurrent per-joint solves.
+    template <class WeightAt>
+    void addColumn(int j, WeightAt&& weight) {
+        const int nv = (int)count.size();
+        const int nstripes = (int)stripe_mutex.size();
+        for (int i = 0; i < nstripes; ++i) {
+            const int s = (j + i) % nstripes;
+            const int v1 = std::min(nv, (s + 1) * kStripeVerts);
+            std::lock_guard<std::mutex> lock(stripe_mutex[s]);
+            for (int v = s * kStripeVerts; v < v1; ++v) offer(v, j, weight(v));
+        }
+    }
+
+    // Offer a single entry.  Not locked: concurrent callers must own
+    // disjoint vertices.
+    void offer(int v, int j, double w) {
+        if (std::isfinite(w) && w > 1e-7) insert(v, j, (float)w);
+    }
+
+    void insert(int v, int j, float w) {
+        VertexSkinData& vsd = out.per_vertex[v];
+        const int n = count[v];
+        int pos = n;
+        while (pos > 0 && (vsd.weights[pos - 1] < w ||
+                           (vsd.weights[pos - 1] == w && vsd.joint_indices[pos - 1] > j))) --pos;
+        if (pos >= k) return;
+        for (int i = std::min(n, k - 1); i > pos; --i) {   // full: drops the last slot
+            vsd.weights[i] = vsd.weights[i - 1];
+            vsd.joint_indices[i] = vsd.joint_indices[i - 1];
+        }
+        vsd.weights[pos] = w;
+        vsd.joint_indices[pos] = j;
+        count[v] = uint8_t(std::min(n + 1, k));
+    }
+
+    // Renormalise to a partition of 1; vertices that received nothing are
+    // hard-bound to `nearest`.
+    SkinWeights finalize(const std::vector<int>& nearest /*fallback owner per vertex*/) {
+        const int nv = (int)count.size();
+        for (int v = 0; v < nv; ++v) {
+            auto& vsd = out.per_vertex[v];
+            double sum = 0.0;
+            for (int i = 0; i < count[v]; ++i) sum += vsd.weights[i];
+            if (sum > 1e-12) {
+                for (int i = 0; i < count[v]; ++i) vsd.weights[i] /= (float)sum;
+            } else {
+                // Degenerate: hard-bind to nearest joint.
+                vsd.joint_indices[0] = (v < (int)nearest.size()) ? nearest[v] : 0;
+                vsd.weights[0] = 1.0f;
+                for (int i = 1; i < kMaxVertexInfluences; ++i) { vsd.joint_indices[i] = 0; vsd.weights[i] = 0.0f; }
+            }
+        }
+        return std::move(out);
+    }
+};
+
+// A few Laplacian smoothing passes on one joint's weights (renormalised in
+// TopKWeights::finalize()).  Cheap way to remove boundary speckle for
+// geodesic.  `tmp` is scratch of size nv.
+void smoothColumn(const MeshOps& ops, std::vector<double>& w, std::vector<double>& tmp, int passes) {
     const int nv = ops.nv;
-    std::vector<double> tmp(nv);
     for (int p = 0; p < passes; ++p) {
-        for (int j = 0; j < nj; ++j) {
-            auto& w = W[j];
-            for (int i = 0; i < nv; ++i) {
-                double acc = w[i]; double wsum = 1.0;
-                for (auto& e : ops.graph[i]) { acc += w[e.first]; wsum += 1.0; }
-                tmp[i] = acc / wsum;
+        for (int i = 0; i < nv; ++i) {
+            double acc = w[i]; double wsum = 1.0;
+            for (int k = ops.graph.begin(i); k < ops.graph.end(i); ++k) {
+                acc += w[ops.graph.col[k]]; wsum += 1.0;
             }
-            w.swap(tmp);
+            tmp[i] = acc / wsum;
         }
+        w.swap(tmp);
     }
 }
 
 // ---------------------------------------------------------------------------
 //  Algorithm 0 (legacy / fallback): nearest-bone inverse distance.
+//  Only a vertex's nearest joints can reach its top k, so the bone BVH is
+//  asked for those directly.  A subtree is skipped once even its closest
+//  point would weigh strictly less (in float, as stored) than the current
+//  k-th candidate, so ties resolve exactly as if every joint were offered.
 // ---------------------------------------------------------------------------
-std::vector<std::vector<double>> weightsNearestBone(
-    const TriangleMesh& mesh, const std::vector<JointBones>& jbs, int nj) {
-    const int nv = (int)mesh.positions.size();
-    std::vector<std::vector<double>> W(nj, std::vector<double>(nv, 0.0));
-    for (int v = 0; v < nv; ++v) {
-        dvec3 p(mesh.positions[v]);
-        for (int j = 0; j < nj; ++j) {
-            double d = distToJoint(p, jbs[j]);
-            W[j][v] = 1.0 / (d * d + 1e-6);
+constexpr int kVertexChunk = 1024;                // vertices per parallel item
+
+void weightsNearestBone(const MeshTopology& topo, const BoneBvh& bvh, TopKWeights& acc) {
+    auto weightOf = [](double d) { return 1.0 / (d * d + 1e-6); };
+    const int nv = topo.num_welded;
+    parallelFor((nv + kVertexChunk - 1) / kVertexChunk, [&](int chunk) {
+        std::vector<std::pair<int, double>> cand;          // (joint, distance)
+        std::vector<int> slot(bvh.njoints, -1);            // joint -> cand index
+        std::vector<float> kth;
+        const int v1 = std::min(nv, (chunk + 1) * kVertexChunk);
+        for (int v = chunk * kVertexChunk; v < v1; ++v) {
+            const dvec3 p(topo.wpos[v]);
+            cand.clear();
+            float bound = 0.0f;                            // k-th best weight so far
+            auto far = [&](double lb) {
+                return (int)cand.size() >= acc.k && (float)weightOf(lb) < bound;
+            };
+            bvh.traverse(p, far, [&](int leaf) {
+                double d[kSegLanes];
+                bvh.leafDist(leaf, p, d);
+                for (int l = 0; l < kSegLanes; ++l) {
+                    const int j = bvh.joint[leaf * kSegLanes + l];
+                    if (j < 0) continue;
+                    if (slot[j] < 0) { slot[j] = (int)cand.size(); cand.push_back({ j, d[l] }); }
+                    else cand[slot[j]].second = std::min(cand[slot[j]].second, d[l]);
+                }
+                if ((int)cand.size() >= acc.k) {
+                    kth.clear();
+                    for (auto& c : cand) kth.push_back((float)weightOf(c.second));
+                    std::nth_element(kth.begin(), kth.begin() + (acc.k - 1), kth.end(), std::greater<float>());
+                    bound = kth[acc.k - 1];
+                }
+            });
+            for (auto& c : cand) { acc.offer(v, c.first, weightOf(c.second)); slot[c.first] = -1; }
         }
-    }
-    return W;
+    });
 }
 
 // ---------------------------------------------------------------------------
 //  Algorithm: Bone Heat.   (L + D) w_j = D p_j ,  D_i = c * mass_i / d_i^2 .
 //  Provably non-negative and a partition of unity (sum_j w_j == 1).
 // ---------------------------------------------------------------------------
-std::vector<std::vector<double>> weightsBoneHeat(
-    const TriangleMesh& mesh, const MeshOps& ops, const std::vector<JointBones>& jbs,
-    int nj, const std::vector<int>& owner, double scale) {
+bool weightsBoneHeat(
+    const MeshTopology& topo, const MeshOps& ops, int nj,
+    const std::vector<int>& owner, const std::vector<double>& owner_dist, double scale,
+    const SkinSolveOptions& opt, SkinSolveStats& st, TopKWeights& acc) {
     const int nv = ops.nv;
     const double c = 1.5;                          // anchoring strength
     const double dfloor = 1e-3 * scale;            // distance floor (avoid div0)
 
     std::vector<double> D(nv, 0.0);
     for (int v = 0; v < nv; ++v) {
-        dvec3 p(mesh.positions[v]);
-        double d = distToJoint(p, jbs[owner[v]]);
-        d = std::max(d, dfloor);
+        double d = std::max(owner_dist[v], dfloor);
         D[v] = c * ops.mass[v] / (d * d);
     }
     std::vector<double> Adiag(nv);
     for (int i = 0; i < nv; ++i) Adiag[i] = ops.Ldiag[i] + D[i];
-    auto matvec = [&](const std::vector<double>& x, std::vector<double>& y) {
-        for (int i = 0; i < nv; ++i) {
-            double s = Adiag[i] * x[i];
-            for (auto& e : ops.Loff[i]) s += e.second * x[e.first];
-            y[i] = s;
-        }
-    };
 
-    std::vector<std::vector<double>> W(nj, std::vector<double>(nv, 0.0));
-    for (int j = 0; j < nj; ++j) {
-        std::vector<double> b(nv, 0.0), x(nv, 0.0);
-        bool any = false;
-        for (int v = 0; v < nv; ++v) if (owner[v] == j) { b[v] = D[v]; x[v] = 1.0; any = true; }
-        if (!any) continue;                       // no territory -> leave zeros
-        if (!cg(matvec, Adiag, b, x, 1500, 1e-5)) { W.clear(); return W; }  // signal fail
-        for (int v = 0; v < nv; ++v) W[j][v] = std::max(0.0, x[v]);
+    // The system matrix is shared by every joint: factor it once.
+    auto t_setup = Clock::now();
+    LdltFactor fac;
+    const bool direct = opt.direct &&
+        factorLdlt(ops.Loff, Adiag, nestedDissectionOrder(ops.graph, topo.wpos), kMaxFactorNnz, fac);
+    AmgHierarchy amg;
+    const bool use_amg = !direct && opt.amg_bone_heat && buildAmg(ops.Loff, Adiag, amg);
+    if (!direct) fprintf(stderr, "[AutoRig] bone heat: factorisation skipped, using %s CG.\n",
+                         use_amg ? "AMG" : "Jacobi");
+    st.setup_ms = msSince(t_setup);
+
+    std::vector<int> solve;                       // joints with territory
+    {
+        std::vector<char> any(nj, 0);
+        for (int v = 0; v < nv; ++v) any[owner[v]] = 1;
+        for (int j = 0; j < nj; ++j) if (any[j]) solve.push_back(j);
+    }
+    std::vector<char> failed(nj, 0);
+    std::vector<int> iters(solve.size(), 0);
+    auto t_solve = Clock::now();
+
+    if (direct) {
+        parallelFor((int)solve.size(), [&](int s) {
+            const int j = solve[s];
+            std::vector<double> x(nv, 0.0), work(nv);
+            for (int v = 0; v < nv; ++v) if (owner[v] == j) x[v] = D[v];
+            solveLdlt(fac, x, work);
+            for (int v = 0; v < nv; ++v)
+                if (!std::isfinite(x[v])) { failed[j] = 1; return; }
+            acc.addColumn(j, [&](int v) { return std::max(0.0, x[v]); });
+        });
+    } else {
+        const int nblocks = ((int)solve.size() + kCgBlockCols - 1) / kCgBlockCols;
+        parallelFor(nblocks, [&](int blk) {
+            const int c0 = blk * kCgBlockCols;
+            const int nb = std::min(kCgBlockCols, (int)solve.size() - c0);
+            std::vector<double> b(size_t(nv) * nb, 0.0), x(size_t(nv) * nb, 0.0);
+            for (int v = 0; v < nv; ++v)
+                for (int c = 0; c < nb; ++c)
+                    if (owner[v] == solve[c0 + c]) { b[size_t(v) * nb + c] = D[v]; x[size_t(v) * nb + c] = 1.0; }
+            auto matvec = [&](const std::vector<double>& in, std::vector<double>& out, int w) {
+                spmvBlock(ops.Loff, Adiag, w, in, out);
+            };
+            const bool ok = use_amg
+                ? cgBlock(matvec, AmgPrecond(amg, nb), nv, nb, b, x, 1500, 1e-5, &iters[c0])
+                : cgBlock(matvec, JacobiPrecond{ Adiag }, nv, nb, b, x, 1500, 1e-5, &iters[c0]);
+            if (!ok) { failed[solve[c0]] = 1; return; }
+            for (int c = 0; c < nb; ++c)
+                acc.addColumn(solve[c0 + c], [&](int v) { return std::max(0.0, x[size_t(v) * nb + c]); });
+        });
     }
-    return W;
+    st.direct = direct;
+    st.amg = use_amg;
+    st.amg_levels = use_amg ? (int)amg.levels.size() : 0;
+    for (int it : iters) { st.cg_iters_max = std::max(st.cg_iters_max, it); st.cg_iters_total += it; }
+    st.solve_ms = msSince(t_solve);
+    for (char f : failed) if (f) return false;
+    return true;
 }
 
 // ---------------------------------------------------------------------------
-//  Algorithm: Geodesic.  Multi-source Dijkstra to each joint's territory,
-//  then a smooth soft-min falloff in world units.
+//  Geodesic distance from one joint's territory; kInf where the territory
+//  can't reach (other mesh components).
 // ---------------------------------------------------------------------------
-std::vector<std::vector<double>> weightsGeodesic(
-    const TriangleMesh& mesh, const MeshOps& ops, const std::vector<JointBones>& jbs,
-    int nj, const std::vector<int>& owner, double scale) {
-    const int nv = ops.nv;
-    const double tau = 0.04 * scale;              // blend width (world units)
 
-    std::vector<std::vector<double>> dist(nj, std::vector<double>(nv, kInf));
+// Multi-source Dijkstra over the edge graph (the default, and the fallback
+// when the heat-method operators can't be factored).
+void distanceDijkstra(const MeshOps& ops, const std::vector<int>& owner, int j,
+                      std::vector<double>& dj) {
+    const int nv = ops.nv;
     using QN = std::pair<double, int>;
-    for (int j = 0; j < nj; ++j) {
-        auto& dj = dist[j];
-        std::priority_queue<QN, std::vector<QN>, std::greater<QN>> pq;
-        for (int v = 0; v < nv; ++v) if (owner[v] == j) { dj[v] = 0.0; pq.push({0.0, v}); }
-        while (!pq.empty()) {
-            auto [d, u] = pq.top(); pq.pop();
-            if (d > dj[u]) continue;
-            for (auto& e : ops.graph[u]) {
-                double nd = d + e.second;
-                if (nd < dj[e.first]) { dj[e.first] = nd; pq.push({nd, e.first}); }
+    dj.assign(nv, kInf);
+    std::priority_queue<QN, std::vector<QN>, std::greater<QN>> pq;
+    for (int v = 0; v < nv; ++v) if (owner[v] == j) { dj[v] = 0.0; pq.push({0.0, v}); }
+    while (!pq.empty()) {
+        auto [d, u] = pq.top(); pq.pop();
+        if (d > dj[u]) continue;
+        for (int k = ops.graph.begin(u); k < ops.graph.end(u); ++k) {
+            const int w = ops.graph.col[k];
+            double nd = d + ops.graph.val[k];
+            if (nd < dj[w]) { dj[w] = nd; pq.push({nd, w}); }
+        }
+    }
+}
+
+// Heat method (Crane, Weischedel & Wardetzky 2013):
+//   1. heat flow      (M + t L) u = u0,   u0 = 1 on the joint's territory
+//   2. unit field     X = -grad u / |grad u|        (per triangle)
+//   3. Poisson        L phi = -div X,   phi shifted to 0 on the sources
+// Both operators depend only on the mesh, so they are factored once and
+// every joint costs two triangular solves plus an O(F) gradient / divergence
+// sweep.  Distances follow the surface rather than edge zig-zags.
+//
+// Backward-Euler heat decays like exp(-d / sqrt(t)); sqrt(t) is kept at no
+// less than 1/kHeatMaxSpan of the model size so far regions don't underflow
+// (at the cost of slightly smoother distances on very dense meshes).
+constexpr double kHeatMaxSpan = 150.0;
+
+struct HeatGeodesic {
+    // Per-triangle gradient basis (grad u = sum_k u_k g[k]) and the corner
+    // cotangents used by the divergence.
+    struct Face {
+        int    v[3];
+        dvec3  g[3];
+        double cot[3];
+    };
+    LdltFactor heat, pois;
+    std::vector<Face> faces;
+    std::vector<int> comp;                         // MeshTopology::comp_index
+    std::vector<double> comp_mass;
+    int ncomp = 0;
+
+    // Factors both operators; false if either exceeds the fill budget.
+    bool build(const MeshTopology& topo, const MeshOps& ops, double scale) {
+        const int nv = ops.nv;
+        const double sqrt_t = std::max(ops.avg_edge, scale / kHeatMaxSpan);
+        const double t = sqrt_t * sqrt_t;
+
+        // Heat operator M + tL and (regularised) Poisson operator L + eps M.
+        // The tiny eps M makes L definite per component; the divergence is
+        // projected to zero mean in distance(), so it doesn't bias phi.
+        double lsum = 0.0, msum = 0.0;
+        for (int i = 0; i < nv; ++i) { lsum += ops.Ldiag[i]; msum += ops.mass[i]; }
+        const double eps = 1e-8 * lsum / std::max(msum, 1e-30);
+
+        CsrMatrix heat_off = ops.Loff;
+        for (double& v : heat_off.val) v *= t;
+        std::vector<double> heat_diag(nv), pois_diag(nv);
+        for (int i = 0; i < nv; ++i) {
+            heat_diag[i] = ops.mass[i] + t * ops.Ldiag[i];
+            pois_diag[i] = ops.Ldiag[i] + eps * ops.mass[i];
+        }
+        const std::vector<int> perm = nestedDissectionOrder(ops.graph, topo.wpos);
+        if (!factorLdlt(heat_off, heat_diag, perm, kMaxFactorNnz, heat)) return false;
+        if (!factorLdlt(ops.Loff, pois_diag, perm, kMaxFactorNnz, pois)) return false;
+
+        faces.reserve(topo.tris.size());
+        for (const glm::ivec3& t : topo.tris) {
+            Face hf;
+            dvec3 p[3];
+            for (int k = 0; k < 3; ++k) {
+                hf.v[k] = t[k];
+                p[k] = dvec3(topo.wpos[hf.v[k]]);
+            }
+            const dvec3 n = glm::cross(p[1] - p[0], p[2] - p[0]);
+            const double a2 = glm::length(n);                    // twice the area
+            if (a2 < 1e-15) continue;
+            const dvec3 nu = n / a2;
+            for (int k = 0; k < 3; ++k) {
+                const dvec3& pk = p[k];
+                const dvec3& pa = p[(k + 1) % 3];
+                const dvec3& pb = p[(k + 2) % 3];
+                hf.g[k] = glm::cross(nu, pb - pa) / a2;          // edge opposite k
+                const dvec3 e0 = pa - pk, e1 = pb - pk;
+                const double cr = glm::length(glm::cross(e0, e1));
+                hf.cot[k] = (cr < 1e-15) ? 0.0 : glm::dot(e0, e1) / cr;
             }
+            faces.push_back(hf);
         }
+
+        comp = topo.comp_index;
+        ncomp = topo.num_components;
+        comp_mass.assign(ncomp, 0.0);
+        for (int v = 0; v < nv; ++v) comp_mass[comp[v]] += ops.mass[v];
+        return true;
     }
-    std::vector<std::vector<double>> W(nj, std::vector<double>(nv, 0.0));
-    for (int v = 0; v < nv; ++v) {
-        double dmin = kInf;
-        for (int j = 0; j < nj; ++j) dmin = std::min(dmin, dist[j][v]);
-        for (int j = 0; j < nj; ++j) {
-            double d = dist[j][v];
-            W[j][v] = std::isinf(d) ? 0.0 : std::exp(-(d - dmin) / tau);
+
+    // Distance from joint j's territory into dj.  Thread-safe.
+    void distance(const MeshTopology& topo, const MeshOps& ops, const std::vector<int>& owner,
+                  int j, std::vector<double>& dj) const {
+        const int nv = ops.nv;
+        dj.assign(nv, kInf);
+        std::vector<double> u(nv, 0.0), div(nv, 0.0), work(nv), comp_sum(ncomp, 0.0);
+        bool any = false;
+        for (int v = 0; v < nv; ++v) if (owner[v] == j) { u[v] = 1.0; any = true; }
+        if (!any) return;
+        solveLdlt(heat, u, work);
+
+        for (const Face& hf : faces) {
+            dvec3 grad(0.0);
+            for (int k = 0; k < 3; ++k) grad += u[hf.v[k]] * hf.g[k];
+            const double len = glm::length(grad);
+            if (!(len > 0.0)) continue;
+            const dvec3 X = -grad / len;
+            for (int k = 0; k < 3; ++k) {
+                const int a = (k + 1) % 3, b = (k + 2) % 3;
+                const dvec3 pk(topo.wpos[hf.v[k]]);
+                const dvec3 ea = dvec3(topo.wpos[hf.v[a]]) - pk;
+                const dvec3 eb = dvec3(topo.wpos[hf.v[b]]) - pk;
+                div[hf.v[k]] += 0.5 * (hf.cot[b] * glm::dot(ea, X) + hf.cot[a] * glm::dot(eb, X));
+            }
+        }
+        for (int v = 0; v < nv; ++v) comp_sum[comp[v]] += div[v];
+        for (int v = 0; v < nv; ++v) div[v] = -(div[v] - ops.mass[v] * comp_sum[comp[v]] / comp_mass[comp[v]]);
+        solveLdlt(pois, div, work);
+
+        // phi is only defined up to a constant per component: shift so the
+        // territory's boundary averages 0 (distances are to the territory, not
+        // its interior).  Heat never crosses into other components, which
+        // stay at kInf.
+        std::vector<double> shift(ncomp, 0.0), cnt(ncomp, 0.0);
+        for (int v = 0; v < nv; ++v) {
+            if (owner[v] != j) continue;
+            bool rim = false;
+            for (int k = ops.graph.begin(v); k < ops.graph.end(v) && !rim; ++k)
+                rim = owner[ops.graph.col[k]] != j;
+            if (rim) { shift[comp[v]] += div[v]; cnt[comp[v]] += 1.0; }
+        }
+        for (int c = 0; c < ncomp; ++c) shift[c] = cnt[c] > 0.0 ? shift[c] / cnt[c] : kInf;
+        for (int v = 0; v < nv; ++v) {
+            if (owner[v] == j) { dj[v] = 0.0; continue; }
+            const double s = shift[comp[v]];
+            if (std::isinf(s) || !std::isfinite(div[v])) continue;
+            dj[v] = std::max(0.0, div[v] - s);
         }
     }
-    smoothWeights(ops, W, nj, 2);
-    return W;
+};
+
+// ---------------------------------------------------------------------------
+//  Algorithm: Geodesic.  Dijkstra distance to each joint's territory (the
+//  heat method when opt.heat_geodesic is set and the operators factor), then
+//  a smooth soft-min falloff in world units.
+// ---------------------------------------------------------------------------
+bool weightsGeodesic(
+    const MeshTopology& topo, const MeshOps& ops,
+    int nj, const std::vector<int>& owner, double scale,
+    const SkinSolveOptions& opt, SkinSolveStats& st, TopKWeights& acc) {
+    const int nv = ops.nv;
+    const double tau = 0.04 * scale;              // blend width (world units)
+
+    auto t_setup = Clock::now();
+    HeatGeodesic heat;
+    const bool want_heat = opt.heat_geodesic && opt.direct;
+    st.direct = want_heat && heat.build(topo, ops, scale);
+    if (want_heat && !st.direct)
+        fprintf(stderr, "[AutoRig] geodesic: heat method unavailable, using Dijkstra.\n");
+    st.setup_ms = msSince(t_setup);
+
+    // Every vertex is at distance 0 from its own territory, so the soft-min
+    // exp(-(d_j - min_i d_i) / tau) needs no cross-joint minimum and each
+    // joint's column is finished (and handed to `acc`) on its own.
+    auto t_solve = Clock::now();
+    parallelFor(nj, [&](int j) {
+        std::vector<double> w, tmp(nv);
+        if (st.direct) heat.distance(topo, ops, owner, j, w);
+        else           distanceDijkstra(ops, owner, j, w);
+        for (int v = 0; v < nv; ++v) w[v] = std::isinf(w[v]) ? 0.0 : std::exp(-w[v] / tau);
+        smoothColumn(ops, w, tmp, 2);
+        acc.addColumn(j, [&](int v) { return w[v]; });
+    });
+    st.solve_ms = msSince(t_solve);
+    return true;
 }
 
 // ---------------------------------------------------------------------------
@@ -379,113 +1376,269 @@ std::vector<std::vector<double>> weightsGeodesic(
 //  with Dirichlet anchors (1 on a joint's territory, 0 on others), bounds
 //  enforced by clamp + renormalise.  Partition of unity holds by construction.
 // ---------------------------------------------------------------------------
-std::vector<std::vector<double>> weightsBiharmonic(
-    const TriangleMesh& mesh, const MeshOps& ops, const std::vector<JointBones>& jbs,
-    int nj, const std::vector<int>& owner, double scale) {
+bool weightsBiharmonic(
+    const MeshTopology& topo, const MeshOps& ops, int nj,
+    const std::vector<int>& owner, const std::vector<double>& owner_dist, double scale,
+    const SkinSolveOptions& opt, SkinSolveStats& st, TopKWeights& acc) {
     const int nv = ops.nv;
     const double r = 0.05 * scale;                // anchor radius
 
     // anchor[v] = owning joint if v is within r of its bone, else -1 (free).
     std::vector<int> anchor(nv, -1);
-    for (int v = 0; v < nv; ++v) {
-        dvec3 p(mesh.positions[v]);
-        double d = distToJoint(p, jbs[owner[v]]);
-        if (d <= r) anchor[v] = owner[v];
-    }
+    for (int v = 0; v < nv; ++v) if (owner_dist[v] <= r) anchor[v] = owner[v];
     // Ensure every joint with territory has at least one anchor (nearest vert).
     std::vector<int> bestV(nj, -1); std::vector<double> bestD(nj, kInf);
     for (int v = 0; v < nv; ++v) {
         int j = owner[v];
-        dvec3 p(mesh.positions[v]);
-        double d = distToJoint(p, jbs[j]);
-        if (d < bestD[j]) { bestD[j] = d; bestV[j] = v; }
+        if (owner_dist[v] < bestD[j]) { bestD[j] = owner_dist[v]; bestV[j] = v; }
     }
     for (int j = 0; j < nj; ++j) if (bestV[j] >= 0 && anchor[bestV[j]] < 0) anchor[bestV[j]] = j;
 
-    auto applyQ = [&](const std::vector<double>& x, std::vector<double>& y) {
-        std::vector<double> t(nv);
-        applyL(ops, x, t);
-        for (int i = 0; i < nv; ++i) t[i] *= ops.minv[i];
-        applyL(ops, t, y);
-    };
     // Jacobi diagonal estimate for Q ~ Ldiag^2 * minv.
     std::vector<double> qdiag(nv);
     for (int i = 0; i < nv; ++i) qdiag[i] = std::max(ops.Ldiag[i] * ops.Ldiag[i] * ops.minv[i], 1e-12);
 
-    std::vector<std::vector<double>> W(nj, std::vector<double>(nv, 0.0));
-    for (int j = 0; j < nj; ++j) {
-        // g = boundary values; free mask.
-        std::vector<double> g(nv, 0.0);
-        bool any = false;
-        for (int v = 0; v < nv; ++v) if (anchor[v] == j) { g[v] = 1.0; any = true; }
-        if (!any) continue;
-        // rhs_free = -(Q * g_only)_free ; operator zeroes constrained dofs.
-        std::vector<double> Qg(nv); applyQ(g, Qg);
-        std::vector<double> b(nv), x(nv, 0.0);
-        for (int v = 0; v < nv; ++v) { b[v] = (anchor[v] < 0) ? -Qg[v] : 0.0; }
-        auto matvecFree = [&](const std::vector<double>& in, std::vector<double>& out) {
-            std::vector<double> z(nv);
-            for (int v = 0; v < nv; ++v) z[v] = (anchor[v] < 0) ? in[v] : 0.0;
-            applyQ(z, out);
-            for (int v = 0; v < nv; ++v) if (anchor[v] >= 0) out[v] = 0.0;
+    // The free set is the same for every joint, so Q_ff is too: assemble it
+    // explicitly (two-ring pattern, Q = L M^-1 L) and factor it once.
+    std::vector<int> fidx(nv, -1), fverts;
+    for (int v = 0; v < nv; ++v) if (anchor[v] < 0) { fidx[v] = (int)fverts.size(); fverts.push_back(v); }
+    const int nf = (int)fverts.size();
+
+    CsrMatrix Qoff;
+    std::vector<double> Qdiag(nf, 0.0);
+    {
+        Qoff.n = nf;
+        Qoff.row_ptr.assign(nf + 1, 0);
+        std::vector<double> acc(nf, 0.0);
+        std::vector<int> touched;
+        std::vector<uint8_t> mark(nf, 0);
+        auto scatter = [&](int k, double s) {             // acc += s * L(k, :)
+            auto add = [&](int c, double a) {
+                const int fc = fidx[c];
+                if (fc < 0) return;
+                if (!mark[fc]) { mark[fc] = 1; touched.push_back(fc); }
+                acc[fc] += s * a;
+            };
+            add(k, ops.Ldiag[k]);
+            for (int q = ops.Loff.begin(k); q < ops.Loff.end(k); ++q) add(ops.Loff.col[q], ops.Loff.val[q]);
         };
-        if (!cg(matvecFree, qdiag, b, x, 3000, 1e-4)) { W.clear(); return W; }
-        for (int v = 0; v < nv; ++v) {
-            double val = (anchor[v] >= 0) ? g[v] : x[v];
-            W[j][v] = glm::clamp(val, 0.0, 1.0);          // enforce bounds
+        for (int fi = 0; fi < nf; ++fi) {
+            const int i = fverts[fi];
+            scatter(i, ops.Ldiag[i] * ops.minv[i]);
+            for (int q = ops.Loff.begin(i); q < ops.Loff.end(i); ++q) {
+                const int k = ops.Loff.col[q];
+                scatter(k, ops.Loff.val[q] * ops.minv[k]);
+            }
+            std::sort(touched.begin(), touched.end());
+            for (int fc : touched) {
+                if (fc == fi) Qdiag[fi] = acc[fc];
+                else { Qoff.col.push_back(fc); Qoff.val.push_back(acc[fc]); }
+                acc[fc] = 0.0; mark[fc] = 0;
+            }
+            touched.clear();
+            Qoff.row_ptr[fi + 1] = (int)Qoff.col.size();
+        }
+    }
+    auto t_setup = Clock::now();
+    std::vector<glm::vec3> fpos(nf);
+    for (int fi = 0; fi < nf; ++fi) fpos[fi] = topo.wpos[fverts[fi]];
+    LdltFactor fac;
+    const bool direct = opt.direct && nf > 0 &&
+        factorLdlt(Qoff, Qdiag, nestedDissectionOrder(Qoff, fpos), kMaxFactorNnz, fac);
+    // AMG preconditioner: Q_ff^-1 ~ L_ff^-1 M L_ff^-1, one V-cycle on the
+    // free-free Laplacian block for each L_ff^-1.  (SA-AMG straight on the
+    // fourth-order Q_ff lets the iteration count grow with resolution; the
+    // factored form stays nearly flat.)
+    AmgHierarchy amg;
+    bool use_amg = false;
+    if (!direct && opt.amg_biharmonic && nf > 0) {
+        CsrMatrix Lff;
+        std::vector<double> Lfdiag(nf);
+        Lff.n = nf;
+        Lff.row_ptr.assign(nf + 1, 0);
+        for (int fi = 0; fi < nf; ++fi) {
+            const int i = fverts[fi];
+            Lfdiag[fi] = ops.Ldiag[i];
+            for (int q = ops.Loff.begin(i); q < ops.Loff.end(i); ++q) {
+                const int fj = fidx[ops.Loff.col[q]];
+                if (fj < 0) continue;
+                Lff.col.push_back(fj);
+                Lff.val.push_back(ops.Loff.val[q]);
+            }
+            Lff.row_ptr[fi + 1] = (int)Lff.col.size();
         }
+        use_amg = buildAmg(Lff, Lfdiag, amg);
     }
-    return W;
+    if (!direct) fprintf(stderr, "[AutoRig] biharmonic: factorisation skipped, using %s CG.\n",
+                         use_amg ? "AMG" : "Jacobi");
+    st.setup_ms = msSince(t_setup);
+
+    std::vector<int> solve;                       // joints with anchors
+    {
+        std::vector<char> any(nj, 0);
+        for (int v = 0; v < nv; ++v) if (anchor[v] >= 0) any[anchor[v]] = 1;
+        for (int j = 0; j < nj; ++j) if (any[j]) solve.push_back(j);
+    }
+    // rhs_free = -(Q g)_free with g = 1 on a joint's anchors, for the joints
+    // solve[c0 .. c0+w) as one row-interleaved block; g and t are scratch.
+    auto freeRhs = [&](int c0, int w, std::vector<double>& g, std::vector<double>& t,
+                       std::vector<double>& b) {
+        for (int v = 0; v < nv; ++v)
+            for (int c = 0; c < w; ++c) g[size_t(v) * w + c] = (anchor[v] == solve[c0 + c]) ? 1.0 : 0.0;
+        applyQBlock(ops, nullptr, w, g, t, b);
+        for (int v = 0; v < nv; ++v)
+            for (int c = 0; c < w; ++c) {
+                double& bv = b[size_t(v) * w + c];
+                bv = (anchor[v] < 0) ? -bv : 0.0;
+            }
+    };
+    std::vector<char> failed(nj, 0);
+    std::vector<int> iters(solve.size(), 0);
+    auto t_solve = Clock::now();
+    auto store = [&](int j, const std::vector<double>& x, int nb, int c) {
+        acc.addColumn(j, [&](int v) {
+            double val = (anchor[v] >= 0) ? (anchor[v] == j ? 1.0 : 0.0) : x[size_t(v) * nb + c];
+            return glm::clamp(val, 0.0, 1.0);             // enforce bounds
+        });
+    };
+
+    // Every buffer a joint (or CG block) needs is allocated once up front;
+    // the triangular solves and CG iterations themselves never allocate.
+    if (direct) {
+        parallelFor((int)solve.size(), [&](int s) {
+            const int j = solve[s];
+            std::vector<double> b(nv), g(nv), t(nv), xf(nf), work(nf);
+            freeRhs(s, 1, g, t, b);
+            for (int fi = 0; fi < nf; ++fi) xf[fi] = b[fverts[fi]];
+            solveLdlt(fac, xf, work);
+            for (int fi = 0; fi < nf; ++fi) {
+                if (!std::isfinite(xf[fi])) { failed[j] = 1; return; }
+                b[fverts[fi]] = xf[fi];
+            }
+            store(j, b, 1, 0);
+        });
+    } else {
+        const int nblocks = ((int)solve.size() + kCgBlockCols - 1) / kCgBlockCols;
+        parallelFor(nblocks, [&](int blk) {
+            const int c0 = blk * kCgBlockCols;
+            const int nb = std::min(kCgBlockCols, (int)solve.size() - c0);
+            const size_t len = size_t(nv) * nb;
+            std::vector<double> b(len), x(len, 0.0), t(len);
+            freeRhs(c0, nb, x, t, b);
+            std::fill(x.begin(), x.end(), 0.0);
+            auto matvecFree = [&](const std::vector<double>& in, std::vector<double>& out, int w) {
+                applyQBlock(ops, &anchor, w, in, t, out);
+            };
+            // V(L_ff) M V(L_ff) on the free dofs (gather / scatter), else Jacobi.
+            AmgPrecond vcycle(amg, use_amg ? nb : 0);
+            std::vector<double> rf(use_amg ? size_t(nf) * nb : 0), zf(rf.size());
+            auto precond = [&](const std::vector<double>& r, std::vector<double>& z, int w) {
+                if (!use_amg) { JacobiPrecond{ qdiag }(r, z, w); return; }
+                for (int fi = 0; fi < nf; ++fi)
+                    for (int c = 0; c < w; ++c) rf[size_t(fi) * w + c] = r[size_t(fverts[fi]) * w + c];
+                vcycle(rf, zf, w);
+                for (int fi = 0; fi < nf; ++fi) {
+                    const double m = ops.mass[fverts[fi]];
+                    for (int c = 0; c < w; ++c) rf[size_t(fi) * w + c] = zf[size_t(fi) * w + c] * m;
+                }
+                vcycle(rf, zf, w);
+                std::fill(z.begin(), z.begin() + size_t(nv) * w, 0.0);
+                for (int fi = 0; fi < nf; ++fi)
+                    for (int c = 0; c < w; ++c) z[size_t(fverts[fi]) * w + c] = zf[size_t(fi) * w + c];
+            };
+            if (!cgBlock(matvecFree, precond, nv, nb, b, x, 3000, 1e-4, &iters[c0])) {
+                failed[solve[c0]] = 1; return;
+            }
+            for (int c = 0; c < nb; ++c) store(solve[c0 + c], x, nb, c);
+        });
+    }
+    st.direct = direct;
+    st.amg = use_amg;
+    st.amg_levels = use_amg ? (int)amg.levels.size() : 0;
+    for (int it : iters) { st.cg_iters_max = std::max(st.cg_iters_max, it); st.cg_iters_total += it; }
+    st.solve_ms = msSince(t_solve);
+    for (char f : failed) if (f) return false;
+    return true;
 }
 
 }  // namespace
 
 // ===========================================================================
-//  Public entry point.
+//  Public entry points.
 // ===========================================================================
 SkinWeights computeSkinWeightsAlgo(const TriangleMesh& mesh, const Skeleton& skeleton,
-                                   SkinWeightAlgo algo, int max_influences) {
-    const int nv = (int)mesh.positions.size();
+                                   SkinWeightAlgo algo, int max_influences,
+                                   const SkinSolveOptions& options, SkinSolveStats* stats) {
+    return computeSkinWeightsAlgo(buildMeshTopology(mesh), skeleton, algo, max_influences,
+                                  options, stats);
+}
+
+SkinWeights computeSkinWeightsAlgo(const MeshTopology& topo, const Skeleton& skeleton,
+                                   SkinWeightAlgo algo, int max_influences,
+                                   const SkinSolveOptions& options, SkinSolveStats* stats) {
+    const int nv = topo.num_welded;               // everything below is per welded vertex
     const int nj = (int)skeleton.joints.size();
     if (nv == 0 || nj == 0) return {};
 
     // Model scale = bounding-box diagonal (used for all relative radii).
     dvec3 lo(kInf), hi(-kInf);
-    for (auto& p : mesh.positions) { lo = glm::min(lo, dvec3(p)); hi = glm::max(hi, dvec3(p)); }
+    for (auto& p : topo.wpos) { lo = glm::min(lo, dvec3(p)); hi = glm::max(hi, dvec3(p)); }
     double scale = glm::length(hi - lo);
     if (!(scale > 1e-9)) scale = 1.0;
 
     std::vector<JointBones> jbs = buildJointBones(skeleton, scale);
 
-    // owner[v] = nearest joint (the vertex's "territory").
+    const BoneBvh bvh(jbs, scale);
+
+    // owner[v] = nearest joint (the vertex's "territory"), owner_dist[v] the
+    // distance to its bones.
     std::vector<int> owner(nv);
-    for (int v = 0; v < nv; ++v) owner[v] = nearestJoint(dvec3(mesh.positions[v]), jbs).first;
+    std::vector<double> owner_dist(nv);
+    parallelFor((nv + kVertexChunk - 1) / kVertexChunk, [&](int chunk) {
+        const int v1 = std::min(nv, (chunk + 1) * kVertexChunk);
+        for (int v = chunk * kVertexChunk; v < v1; ++v)
+            std::tie(owner[v], owner_dist[v]) = bvh.nearest(dvec3(topo.wpos[v]));
+    });
+
+    // Welded result -> one entry per original vertex.
+    auto unweld = [&](SkinWeights&& welded) {
+        SkinWeights out;
+        out.per_vertex.resize(topo.nv);
+        for (int v = 0; v < topo.nv; ++v) out.per_vertex[v] = welded.per_vertex[topo.wid[v]];
+        return out;
+    };
 
     auto runFallback = [&]() {
         fprintf(stderr, "[AutoRig] weight solve fell back to nearest-bone.\n");
-        auto W = weightsNearestBone(mesh, jbs, nj);
-        return finalize(W, nv, nj, max_influences, owner);
+        TopKWeights acc(nv, max_influences);
+        weightsNearestBone(topo, bvh, acc);
+        return unweld(acc.finalize(owner));
     };
 
     if (algo == SkinWeightAlgo::kNearestBone) {
-        auto W = weightsNearestBone(mesh, jbs, nj);
-        return finalize(W, nv, nj, max_influences, owner);
+        TopKWeights acc(nv, max_influences);
+        weightsNearestBone(topo, bvh, acc);
+        return unweld(acc.finalize(owner));
     }
 
-    MeshOps ops = buildMeshOps(mesh);
+    MeshOps ops = buildMeshOps(topo);
 
-    std::vector<std::vector<double>> W;
+    SkinSolveStats st;
+    TopKWeights acc(nv, max_influences);
+    bool ok = false;
     switch (algo) {
-        case SkinWeightAlgo::kBoneHeat:   W = weightsBoneHeat(mesh, ops, jbs, nj, owner, scale); break;
-        case SkinWeightAlgo::kGeodesic:   W = weightsGeodesic(mesh, ops, jbs, nj, owner, scale); break;
-        case SkinWeightAlgo::kBiharmonic: W = weightsBiharmonic(mesh, ops, jbs, nj, owner, scale); break;
+        case SkinWeightAlgo::kBoneHeat:   ok = weightsBoneHeat(topo, ops, nj, owner, owner_dist, scale, options, st, acc); break;
+        case SkinWeightAlgo::kGeodesic:   ok = weightsGeodesic(topo, ops, nj, owner, scale, options, st, acc); break;
+        case SkinWeightAlgo::kBiharmonic: ok = weightsBiharmonic(topo, ops, nj, owner, owner_dist, scale, options, st, acc); break;
         default: break;
     }
-    if (W.empty()) return runFallback();          // solver signalled failure
+    if (stats) *stats = st;
+    if (!ok) return runFallback();                // solver signalled failure
 
     const char* nm = skinWeightAlgoName(algo);
-    fprintf(stderr, "[AutoRig] skinning: %d verts, %d joints, algo=%s\n", nv, nj, nm);
-    return finalize(W, nv, nj, max_influences, owner);
+    fprintf(stderr, "[AutoRig] skinning: %d verts (%d welded), %d joints, algo=%s\n",
+            topo.nv, nv, nj, nm);
+    return unweld(acc.finalize(owner));
 }
 
 }  // namespace auto_rig
@@ -9,12 +9,16 @@
 //    * Bone Heat   — surface heat-diffusion (Pinocchio-style, no embree
 //                    visibility): solve (L + lambda*H) w_j = lambda*H*p_j.
 //                    Provably non-negative and a partition of unity.
-//    * Geodesic    — multi-source Dijkstra distance to each joint's surface
-//                    "territory" + smooth falloff.  No bleeding across gaps.
+//    * Geodesic    — surface distance (edge-graph Dijkstra, or the heat
+//                    method on request) to each joint's "territory" + smooth
+//                    falloff.  No bleeding across gaps.
 //    * Biharmonic  — constrained bi-Laplacian solve (bounded biharmonic
 //                    weights, bounds enforced by clamp+renormalise).
 //
 //  All paths:
+//    - run on the welded surface of a shared MeshTopology (mesh_topology.h),
+//      so seams split by UVs / normals don't cut the solves apart; results
+//      are copied back to every original vertex;
 //    - bind limb geometry to the PROXIMAL (parent) joint via per-joint
 //      "outgoing" bone segments, and add a virtual tip bone at every leaf
 //      joint (head / hands / feet) so terminal geometry is anchored;
@@ -25,18 +29,57 @@
 // ============================================================================
 
 #include "plugins/auto_rig/rig_types.h"
+#include "plugins/auto_rig/mesh_topology.h"
 
 namespace plugins {
 namespace auto_rig {
 
+// Linear-solver controls.  By default each system is factored once (sparse
+// LDL^T) and solved per joint; CG only runs when the factor would not fit in
+// memory, or when `direct` is off.  The AMG flags swap CG's Jacobi
+// preconditioner for smoothed-aggregation multigrid (see autorig_solve_bench
+// for iteration counts and timings).  `heat_geodesic` measures kGeodesic
+// distances with the factored heat method instead of Dijkstra; its distances
+// run a few percent shorter, so the weights differ slightly.
+struct SkinSolveOptions {
+    bool direct         = true;      // allow the factor-once direct solve
+    bool amg_bone_heat  = false;     // AMG-preconditioned CG for kBoneHeat
+    bool amg_biharmonic = false;     // AMG-preconditioned CG for kBiharmonic
+    bool heat_geodesic  = false;     // heat-method distances for kGeodesic (needs direct)
+};
+
+// Solver telemetry for benchmarking (left zeroed for the other algorithms).
+struct SkinSolveStats {
+    bool   direct         = false;   // solved by factorisation
+    bool   amg            = false;   // CG ran with the AMG preconditioner
+    int    amg_levels     = 0;
+    int    cg_iters_max   = 0;       // over all joints
+    int    cg_iters_total = 0;
+    double setup_ms       = 0.0;     // factorisation / AMG hierarchy
+    double solve_ms       = 0.0;     // all joints
+};
+
 // Compute per-vertex skin weights for `mesh` against `skeleton` using `algo`.
 // `max_influences` is clamped to [1,kMaxVertexInfluences] (the VertexSkinData
-// capacity — currently 8 for the 8-bone skinning debug path).
-SkinWeights computeSkinWeightsAlgo(const TriangleMesh& mesh,
-                                   const Skeleton&     skeleton,
-                                   SkinWeightAlgo      algo,
-                                   int                 max_influences =
-                                       kMaxVertexInfluences);
+// capacity — currently 8 for the 8-bone skinning debug path).  `stats`, if
+// given, receives the solver telemetry.
+SkinWeights computeSkinWeightsAlgo(const TriangleMesh&     mesh,
+                                   const Skeleton&         skeleton,
+                                   SkinWeightAlgo          algo,
+                                   int                     max_influences =
+                                       kMaxVertexInfluences,
+                                   const SkinSolveOptions& options = {},
+                                   SkinSolveStats*         stats = nullptr);
+
+// Same, on a prebuilt topology (callers that keep one cached per mesh skip
+// the weld / graph assembly).
+SkinWeights computeSkinWeightsAlgo(const MeshTopology&     topology,
+                                   const Skeleton&         skeleton,
+                                   SkinWeightAlgo          algo,
+                                   int                     max_influences =
+                                       kMaxVertexInfluences,
+                                   const SkinSolveOptions& options = {},
+                                   SkinSolveStats*         stats = nullptr);
 
 }  // namespace auto_rig
 }  // namespace plugins
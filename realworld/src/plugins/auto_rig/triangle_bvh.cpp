@@ -0,0 +1,147 @@
+// ============================================================================
+//  triangle_bvh.cpp  —  see header for the high-level description.
+// ============================================================================
+
+#include "plugins/auto_rig/triangle_bvh.h"
+
+#include <algorithm>
+
+namespace plugins {
+namespace auto_rig {
+
+namespace {
+
+constexpr int kBins = 12;
+
+float halfArea(const glm::vec3& lo, const glm::vec3& hi) {
+    const glm::vec3 e = glm::max(hi - lo, glm::vec3(0.0f));
+    return e.x * e.y + e.y * e.z + e.z * e.x;
+}
+
+}  // namespace
+
+TriangleBvh::TriangleBvh(const std::vector<glm::vec3>& positions,
+                         const std::vector<glm::ivec3>& tris, float t_min)
+    : t_min_(t_min) {
+    if (tris.empty()) return;
+    glm::vec3 slo(1e30f), shi(-1e30f);
+    for (const auto& p : positions) { slo = glm::min(slo, p); shi = glm::max(shi, p); }
+    const float scene_pad = 1e-5f * glm::length(shi - slo);
+
+    // Triangle boxes grow by a share of their own size (covers the 1e-5
+    // barycentric tolerance of the hit test) plus a scene-relative margin
+    // (covers float rounding in the slab test).
+    std::vector<Ref> refs(tris.size());
+    for (size_t i = 0; i < tris.size(); ++i) {
+        const glm::vec3& a = positions[tris[i].x];
+        const glm::vec3& b = positions[tris[i].y];
+        const glm::vec3& c = positions[tris[i].z];
+        glm::vec3 lo = glm::min(a, glm::min(b, c)), hi = glm::max(a, glm::max(b, c));
+        const glm::vec3 ext = hi - lo;
+        const float pad = 1e-3f * std::max(ext.x, std::max(ext.y, ext.z)) + scene_pad;
+        lo -= glm::vec3(pad); hi += glm::vec3(pad);
+        refs[i] = { lo, hi, 0.5f * (lo + hi), static_cast<int>(i) };
+    }
+
+    nodes_.reserve(2 * tris.size() / kLeafSize + 1);
+    v0_.reserve(tris.size()); e1_.reserve(tris.size()); e2_.reserve(tris.size());
+    tri_index_.reserve(tris.size());
+    build(refs, 0, static_cast<int>(refs.size()), 0);
+
+    for (int ti : tri_index_) {
+        const glm::vec3& v0 = positions[tris[ti].x];
+        v0_.push_back(v0);
+        e1_.push_back(positions[tris[ti].y] - v0);
+        e2_.push_back(positions[tris[ti].z] - v0);
+    }
+}
+
+int TriangleBvh::build(std::vector<Ref>& refs, int lo, int hi, int depth) {
+    const int id = static_cast<int>(nodes_.size());
+    nodes_.emplace_back();
+    glm::vec3 blo(1e30f), bhi(-1e30f), clo(1e30f), chi(-1e30f);
+    for (int i = lo; i < hi; ++i) {
+        blo = glm::min(blo, refs[i].lo); bhi = glm::max(bhi, refs[i].hi);
+        clo = glm::min(clo, refs[i].c);  chi = glm::max(chi, refs[i].c);
+    }
+    nodes_[id].lo = blo;
+    nodes_[id].hi = bhi;
+    const int n = hi - lo;
+
+    auto makeLeaf = [&] {
+        nodes_[id].first = static_cast<int>(tri_index_.size());
+        nodes_[id].count = n;
+        for (int i = lo; i < hi; ++i) tri_index_.push_back(refs[i].tri);
+        return id;
+    };
+    if (n <= 2) return makeLeaf();
+
+    // Binned SAH over all three axes; cost in units of one triangle test with
+    // a node visit costing about one test.
+    int   best_axis = -1, best_split = 0;
+    float best_cost = 1e30f;
+    const glm::vec3 cext = chi - clo;
+    if (depth < kMaxDepth - 24) {
+        for (int a = 0; a < 3; ++a) {
+            if (!(cext[a] > 0.0f)) continue;
+            const float scale = kBins / cext[a];
+            int cnt[kBins] = {};
+            glm::vec3 bl[kBins], bh[kBins];
+            for (int b = 0; b < kBins; ++b) { bl[b] = glm::vec3(1e30f); bh[b] = glm::vec3(-1e30f); }
+            for (int i = lo; i < hi; ++i) {
+                const int b = std::min(kBins - 1, static_cast<int>((refs[i].c[a] - clo[a]) * scale));
+                ++cnt[b];
+                bl[b] = glm::min(bl[b], refs[i].lo); bh[b] = glm::max(bh[b], refs[i].hi);
+            }
+            float right_area[kBins];
+            int   right_cnt[kBins];
+            glm::vec3 rl(1e30f), rh(-1e30f);
+            int rc = 0;
+            for (int b = kBins - 1; b > 0; --b) {
+                rl = glm::min(rl, bl[b]); rh = glm::max(rh, bh[b]); rc += cnt[b];
+                right_area[b] = halfArea(rl, rh); right_cnt[b] = rc;
+            }
+            glm::vec3 ll(1e30f), lh(-1e30f);
+            int lc = 0;
+            for (int b = 0; b < kBins - 1; ++b) {
+                ll = glm::min(ll, bl[b]); lh = glm::max(lh, bh[b]); lc += cnt[b];
+                if (lc == 0 || right_cnt[b + 1] == 0) continue;
+                const float cost = halfArea(ll, lh) * lc + right_area[b + 1] * right_cnt[b + 1];
+                if (cost < best_cost) { best_cost = cost; best_axis = a; best_split = b + 1; }
+            }
+        }
+    }
+
+    int mid;
+    const float leaf_cost = static_cast<float>(n);
+    const float split_cost = best_axis >= 0 ? 1.0f + best_cost / halfArea(blo, bhi) : 1e30f;
+    if (best_axis >= 0 && (split_cost < leaf_cost || n > kLeafSize)) {
+        const int a = best_axis;
+        const float scale = kBins / cext[a];
+        const float c0 = clo[a];
+        auto it = std::partition(refs.begin() + lo, refs.begin() + hi, [&](const Ref& r) {
+            return std::min(kBins - 1, static_cast<int>((r.c[a] - c0) * scale)) < best_split;
+        });
+        mid = static_cast<int>(it - refs.begin());
+    } else if (n > kLeafSize) {
+        // No usable SAH split (coincident centroids or too deep): halve by
+        // count along the widest centroid axis, which bounds the depth.
+        const int a = (cext.x >= cext.y && cext.x >= cext.z) ? 0 : (cext.y >= cext.z ? 1 : 2);
+        mid = (lo + hi) / 2;
+        std::nth_element(refs.begin() + lo, refs.begin() + mid, refs.begin() + hi,
+                         [a](const Ref& x, const Ref& y) {
+                             return x.c[a] < y.c[a] || (x.c[a] == y.c[a] && x.tri < y.tri);
+                         });
+    } else {
+        return makeLeaf();
+    }
+
+    build(refs, lo, mid, depth + 1);               // left child is id + 1
+    const int r = build(refs, mid, hi, depth + 1);
+    nodes_[id].first = r;
+    nodes_[id].count = 0;
+    return id;
+}
+
+}  // namespace auto_rig
+}  // namespace plugins
@@ -0,0 +1,185 @@
+#pragma once
+// ============================================================================
+//  triangle_bvh.h
+//
+//  Bounding-volume hierarchy over a triangle list for the auto-rig's ray
+//  passes (joint centring, skin classification, bone seeding), which used to
+//  test every ray against every triangle.
+//
+//    * build       — binned SAH over triangle centroids, <= kLeafSize
+//                    triangles per leaf, nodes in depth-first order.
+//    * closestHit  — nearest intersection accepted by a filter.
+//    * anyHit      — every intersection, in no particular order, until the
+//                    visitor asks to stop.
+//
+//  The ray/triangle test is the plugin's Möller–Trumbore with the same
+//  operations in the same order, so t/u/v are bit-identical to the old
+//  brute-force loops.  Node boxes are padded well beyond the test's
+//  barycentric tolerance so traversal never culls a triangle the test would
+//  accept, and equal-t hits resolve to the lowest triangle index, exactly
+//  like a scan in input order.
+// ============================================================================
+
+#include <cmath>
+#include <utility>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace plugins {
+namespace auto_rig {
+
+class TriangleBvh {
+public:
+    static constexpr int kLeafSize = 4;
+
+    struct Hit {
+        int   tri = -1;                    // index into the input triangle list
+        float t = 0.0f;                    // ray parameter
+        float u = 0.0f, v = 0.0f;          // barycentrics of corners y, z
+    };
+
+    TriangleBvh() = default;
+    // Hits at t <= t_min are ignored (self-intersection guard).
+    TriangleBvh(const std::vector<glm::vec3>& positions,
+                const std::vector<glm::ivec3>& tris, float t_min);
+
+    bool empty() const { return nodes_.empty(); }
+
+    // Nearest hit for which accept(tri, t) is true.
+    template <class Accept>
+    bool closestHit(const glm::vec3& o, const glm::vec3& d, Accept&& accept,
+                    Hit& hit) const {
+        hit = Hit{};
+        if (nodes_.empty()) return false;
+        const glm::vec3 inv = invDir(d);
+        float best = 1e30f;
+        int stack[kMaxDepth * 2];
+        int sp = 0;
+        stack[sp++] = 0;
+        while (sp > 0) {
+            const int id = stack[--sp];
+            const Node& n = nodes_[id];
+            float tn;
+            if (!slab(n, o, inv, best, tn)) continue;
+            if (n.count > 0) {
+                for (int k = n.first; k < n.first + n.count; ++k) {
+                    float tt, u, v;
+                    if (!intersect(k, o, d, tt, u, v)) continue;
+                    const int ti = tri_index_[k];
+                    if (tt > best || (tt == best && ti > hit.tri && hit.tri >= 0)) continue;
+                    if (!accept(ti, tt)) continue;
+                    best = tt;
+                    hit.tri = ti; hit.t = tt; hit.u = u; hit.v = v;
+                }
+                continue;
+            }
+            // Nearer child on top of the stack.
+            const int l = id + 1, r = n.first;
+            float tl, tr;
+            const bool hl = slab(nodes_[l], o, inv, best, tl);
+            const bool hr = slab(nodes_[r], o, inv, best, tr);
+            if (hl && hr) {
+                if (tl <= tr) { stack[sp++] = r; stack[sp++] = l; }
+                else          { stack[sp++] = l; stack[sp++] = r; }
+            } else if (hl) {
+                stack[sp++] = l;
+            } else if (hr) {
+                stack[sp++] = r;
+            }
+        }
+        return hit.tri >= 0;
+    }
+
+    bool closestHit(const glm::vec3& o, const glm::vec3& d, Hit& hit) const {
+        return closestHit(o, d, [](int, float) { return true; }, hit);
+    }
+
+    // visit(tri, t) for every hit; returning true ends the traversal.
+    template <class Visit>
+    void anyHit(const glm::vec3& o, const glm::vec3& d, Visit&& visit) const {
+        if (nodes_.empty()) return;
+        const glm::vec3 inv = invDir(d);
+        int stack[kMaxDepth * 2];
+        int sp = 0;
+        stack[sp++] = 0;
+        while (sp > 0) {
+            const int id = stack[--sp];
+            const Node& n = nodes_[id];
+            float tn;
+            if (!slab(n, o, inv, 1e30f, tn)) continue;
+            if (n.count > 0) {
+                for (int k = n.first; k < n.first + n.count; ++k) {
+                    float tt, u, v;
+                    if (intersect(k, o, d, tt, u, v) && visit(tri_index_[k], tt)) return;
+                }
+                continue;
+            }
+            stack[sp++] = n.first;
+            stack[sp++] = id + 1;
+        }
+    }
+
+private:
+    static constexpr int kMaxDepth = 64;
+
+    struct Node {
+        glm::vec3 lo, hi;
+        int first = 0;                     // leaf: first triangle; inner: right child
+        int count = 0;                     // leaf: triangle count; inner: 0
+    };
+    struct Ref { glm::vec3 lo, hi, c; int tri; };
+
+    int build(std::vector<Ref>& refs, int lo, int hi, int depth);
+
+    static glm::vec3 invDir(const glm::vec3& d) {
+        // A zero component becomes a huge finite slope: the padded boxes
+        // absorb the (conservative) error and no 0 * inf NaNs appear.
+        return glm::vec3(1.0f / (d.x != 0.0f ? d.x : 1e-30f),
+                         1.0f / (d.y != 0.0f ? d.y : 1e-30f),
+                         1.0f / (d.z != 0.0f ? d.z : 1e-30f));
+    }
+
+    // Ray vs node box over [0, tmax]; tnear is the entry distance.
+    static bool slab(const Node& n, const glm::vec3& o, const glm::vec3& inv,
+                     float tmax, float& tnear) {
+        float t0 = 0.0f, t1 = tmax;
+        for (int a = 0; a < 3; ++a) {
+            float ta = (n.lo[a] - o[a]) * inv[a], tb = (n.hi[a] - o[a]) * inv[a];
+            if (ta > tb) std::swap(ta, tb);
+            t0 = ta > t0 ? ta : t0;
+            t1 = tb < t1 ? tb : t1;
+        }
+        tnear = t0;
+        return t0 <= t1;
+    }
+
+    // Möller–Trumbore, operation for operation as the plugin's rayTri.
+    bool intersect(int k, const glm::vec3& o, const glm::vec3& d, float& outT,
+                   float& bu, float& bv) const {
+        const glm::vec3& v0 = v0_[k];
+        const glm::vec3& e1 = e1_[k];
+        const glm::vec3& e2 = e2_[k];
+        const glm::vec3 pv = glm::cross(d, e2);
+        const float det = glm::dot(e1, pv);
+        if (std::fabs(det) < 1e-12f) return false;
+        const float inv = 1.0f / det;
+        const glm::vec3 tvec = o - v0;
+        const float u = glm::dot(tvec, pv) * inv;
+        if (u < -1e-5f || u > 1.0f + 1e-5f) return false;
+        const glm::vec3 qv = glm::cross(tvec, e1);
+        const float v = glm::dot(d, qv) * inv;
+        if (v < -1e-5f || u + v > 1.0f + 1e-5f) return false;
+        const float tt = glm::dot(e2, qv) * inv;
+        if (tt <= t_min_) return false;
+        outT = tt; bu = u; bv = v;
+        return true;
+    }
+
+    std::vector<Node>      nodes_;         // nodes_[0] is the root
+    std::vector<glm::vec3> v0_, e1_, e2_;  // triangles in leaf order
+    std::vector<int>       tri_index_;     // leaf order -> input triangle
+    float                  t_min_ = 0.0f;
+};
+
+}  // namespace auto_rig
+}  // namespace plugins